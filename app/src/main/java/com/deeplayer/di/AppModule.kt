@@ -1,9 +1,11 @@
 package com.deeplayer.di
 
 import android.content.Context
+import android.content.SharedPreferences
 import com.deeplayer.core.contracts.AudioPreprocessor
 import com.deeplayer.core.contracts.WhisperTranscriber
 import com.deeplayer.feature.audiopreprocessor.AndroidAudioPreprocessor
+import com.deeplayer.feature.inferenceengine.InferenceThreadPolicy
 import com.deeplayer.feature.inferenceengine.WhisperCppTranscriber
 import dagger.Module
 import dagger.Provides
@@ -25,14 +27,22 @@ fun provideAudioPreprocessor(): AudioPreprocessor = AndroidAudioPreprocessor()
 
   @Provides
   @Singleton
-  fun provideWhisperTranscriber(@ApplicationContext context: Context): WhisperTranscriber {
+  fun provideInferenceThreadPolicy(prefs: SharedPreferences): InferenceThreadPolicy =
+    InferenceThreadPolicy(prefs)
+
+  @Provides
+  @Singleton
+  fun provideWhisperTranscriber(
+    @ApplicationContext context: Context,
+    threadPolicy: InferenceThreadPolicy,
+  ): WhisperTranscriber {
     val modelFile = File(context.filesDir, WHISPER_MODEL_ASSET)
     if (!modelFile.exists()) {
       context.assets.open(WHISPER_MODEL_ASSET).use { input ->
         modelFile.outputStream().use { output -> input.copyTo(output) }
       }
     }
-    val transcriber = WhisperCppTranscriber()
+    val transcriber = WhisperCppTranscriber(threadPolicy)
     check(transcriber.loadModel(modelFile.absolutePath)) {
       "Failed to load Whisper model: ${modelFile.absolutePath}"
     }
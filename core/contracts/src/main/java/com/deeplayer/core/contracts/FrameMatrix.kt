@@ -0,0 +1,219 @@
+package com.deeplayer.core.contracts
+
+/** Storage encoding of a [FrameMatrix]. */
+enum class FrameFormat(val bytesPerValue: Int) {
+  /** 32-bit floats; exact. */
+  FLOAT32(4),
+  /** IEEE half floats; about 3 significant digits, range ±65504. */
+  FLOAT16(2),
+  /** 8-bit codes with a per-frame scale and offset; 255 steps across each frame's range. */
+  INT8(1),
+}
+
+/**
+ * Row-major `[numFrames × numColumns]` matrix of per-frame features, such as log-mel bands or
+ * phoneme log-probabilities, held in one of the [FrameFormat] encodings.
+ *
+ * Long tracks produce tens of thousands of frames, so the compact encodings halve or quarter the
+ * memory and JNI copies of a float array. Consumers read values through [get] or decode one frame
+ * at a time with [copyFrame] instead of expanding the whole matrix.
+ */
+sealed class FrameMatrix(val numFrames: Int, val numColumns: Int) {
+
+  abstract val format: FrameFormat
+
+  /** Decoded value at [frame], [column]. */
+  abstract operator fun get(frame: Int, column: Int): Float
+
+  /** Decode [frame] into `dst[0 until numColumns]`. */
+  abstract fun copyFrame(frame: Int, dst: FloatArray)
+
+  /** Bytes held by the encoded values and per-frame parameters. */
+  abstract val sizeInBytes: Long
+
+  /** Decode every frame into a new float array. */
+  fun toFloatArray(): FloatArray {
+    val out = FloatArray(numFrames * numColumns)
+    val row = FloatArray(numColumns)
+    for (t in 0 until numFrames) {
+      copyFrame(t, row)
+      row.copyInto(out, t * numColumns)
+    }
+    return out
+  }
+
+  class Float32(val data: FloatArray, numFrames: Int, numColumns: Int) :
+    FrameMatrix(numFrames, numColumns) {
+    init {
+      require(data.size >= numFrames * numColumns) { "data too short for $numFrames frames" }
+    }
+
+    override val format = FrameFormat.FLOAT32
+
+    override fun get(frame: Int, column: Int): Float = data[frame * numColumns + column]
+
+    override fun copyFrame(frame: Int, dst: FloatArray) {
+      data.copyInto(dst, 0, frame * numColumns, (frame + 1) * numColumns)
+    }
+
+    override val sizeInBytes: Long
+      get() = numFrames.toLong() * numColumns * 4
+  }
+
+  /** Values stored as IEEE 754 binary16 bit patterns. */
+  class Float16(val data: ShortArray, numFrames: Int, numColumns: Int) :
+    FrameMatrix(numFrames, numColumns) {
+    init {
+      require(data.size >= numFrames * numColumns) { "data too short for $numFrames frames" }
+    }
+
+    override val format = FrameFormat.FLOAT16
+
+    override fun get(frame: Int, column: Int): Float =
+      halfToFloat(data[frame * numColumns + column])
+
+    override fun copyFrame(frame: Int, dst: FloatArray) {
+      val base = frame * numColumns
+      for (c in 0 until numColumns) dst[c] = halfToFloat(data[base + c])
+    }
+
+    override val sizeInBytes: Long
+      get() = numFrames.toLong() * numColumns * 2
+  }
+
+  /**
+   * Values stored as unsigned 8-bit codes: `value = offsets[frame] + code * scales[frame]`.
+   *
+   * Each frame spans its own range, capped at [MAX_INT8_RANGE] below the frame maximum. Lower
+   * values, including -Inf, clamp to the bottom of the range.
+   */
+  class Int8(
+    val data: ByteArray,
+    val scales: FloatArray,
+    val offsets: FloatArray,
+    numFrames: Int,
+    numColumns: Int,
+  ) : FrameMatrix(numFrames, numColumns) {
+    init {
+      require(data.size >= numFrames * numColumns) { "data too short for $numFrames frames" }
+      require(scales.size >= numFrames && offsets.size >= numFrames) {
+        "missing per-frame scales"
+      }
+    }
+
+    override val format = FrameFormat.INT8
+
+    override fun get(frame: Int, column: Int): Float =
+      offsets[frame] + (data[frame * numColumns + column].toInt() and 0xFF) * scales[frame]
+
+    override fun copyFrame(frame: Int, dst: FloatArray) {
+      val base = frame * numColumns
+      val scale = scales[frame]
+      val offset = offsets[frame]
+      for (c in 0 until numColumns) dst[c] = offset + (data[base + c].toInt() and 0xFF) * scale
+    }
+
+    override val sizeInBytes: Long
+      get() = numFrames.toLong() * numColumns + numFrames.toLong() * 8
+  }
+
+  companion object {
+    /**
+     * Widest span of a single [Int8] frame. Log-probabilities this far below the best token are
+     * negligible, and log-mel values span about 33 (a 1e-10 energy floor to full scale).
+     */
+    const val MAX_INT8_RANGE = 64f
+
+    /** Encode row-major [data] of [numColumns] values per frame in [format]. */
+    fun encode(data: FloatArray, numColumns: Int, format: FrameFormat): FrameMatrix {
+      require(numColumns > 0) { "numColumns must be positive" }
+      val numFrames = data.size / numColumns
+      return when (format) {
+        FrameFormat.FLOAT32 -> Float32(data, numFrames, numColumns)
+        FrameFormat.FLOAT16 -> {
+          val half = ShortArray(numFrames * numColumns) { floatToHalf(data[it]) }
+          Float16(half, numFrames, numColumns)
+        }
+        FrameFormat.INT8 -> quantize(data, numFrames, numColumns)
+      }
+    }
+
+    private fun quantize(data: FloatArray, numFrames: Int, numColumns: Int): Int8 {
+      val codes = ByteArray(numFrames * numColumns)
+      val scales = FloatArray(numFrames)
+      val offsets = FloatArray(numFrames)
+      for (t in 0 until numFrames) {
+        val base = t * numColumns
+        var lo = data[base]
+        var hi = data[base]
+        for (c in 1 until numColumns) {
+          lo = minOf(lo, data[base + c])
+          hi = maxOf(hi, data[base + c])
+        }
+        if (!hi.isFinite()) {
+          // Nothing to scale; every code decodes to hi.
+          offsets[t] = hi
+          continue
+        }
+        lo = maxOf(lo, hi - MAX_INT8_RANGE)
+        offsets[t] = lo
+        if (hi == lo) continue
+        scales[t] = (hi - lo) / 255f
+        val inv = 255f / (hi - lo)
+        for (c in 0 until numColumns) {
+          val code = ((data[base + c] - lo) * inv).coerceIn(0f, 255f) + 0.5f
+          codes[base + c] = code.toInt().toByte()
+        }
+      }
+      return Int8(codes, scales, offsets, numFrames, numColumns)
+    }
+
+    /** Round [value] to the nearest binary16 (ties to even), as the native NEON/F16C kernels do. */
+    fun floatToHalf(value: Float): Short {
+      val bits = value.toRawBits()
+      val sign = (bits ushr 16) and 0x8000
+      val exp = (bits ushr 23) and 0xFF
+      val mantissa = bits and 0x7FFFFF
+      if (exp == 0xFF) {
+        // Inf stays Inf; NaN stays a quiet NaN.
+        return (sign or 0x7C00 or (if (mantissa != 0) 0x200 else 0)).toShort()
+      }
+      val halfExp = exp - 127 + 15
+      if (halfExp >= 0x1F) return (sign or 0x7C00).toShort()
+      if (halfExp <= 0) {
+        // Subnormal half: shift the full significand into units of 2^-24.
+        if (halfExp < -10) return sign.toShort()
+        val significand = mantissa or 0x800000
+        val shift = 14 - halfExp
+        return (sign or roundShift(significand, shift)).toShort()
+      }
+      // A carry out of the mantissa correctly bumps the exponent, up to Inf.
+      return (sign or ((halfExp shl 10) + roundShift(mantissa, 13))).toShort()
+    }
+
+    /** Exact value of the binary16 bit pattern [half]. */
+    fun halfToFloat(half: Short): Float {
+      val h = half.toInt() and 0xFFFF
+      val sign = (h and 0x8000) shl 16
+      val exp = (h ushr 10) and 0x1F
+      val mantissa = h and 0x3FF
+      return when {
+        exp == 0x1F -> Float.fromBits(sign or 0x7F800000 or (mantissa shl 13))
+        exp != 0 -> Float.fromBits(sign or ((exp + 112) shl 23) or (mantissa shl 13))
+        sign != 0 -> -(mantissa * HALF_SUBNORMAL_UNIT)
+        else -> mantissa * HALF_SUBNORMAL_UNIT
+      }
+    }
+
+    /** 2^-24, the value of one unit of a subnormal half. */
+    private const val HALF_SUBNORMAL_UNIT = 5.9604645e-8f
+
+    private fun roundShift(value: Int, shift: Int): Int {
+      val result = value ushr shift
+      val remainder = value and ((1 shl shift) - 1)
+      val half = 1 shl (shift - 1)
+      return if (remainder > half || (remainder == half && (result and 1) != 0)) result + 1
+      else result
+    }
+  }
+}
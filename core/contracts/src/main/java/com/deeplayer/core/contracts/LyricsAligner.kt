@@ -0,0 +1,29 @@
+package com.deeplayer.core.contracts
+
+/** Aligns lyrics to a frame-level phoneme log-probability matrix by CTC forced alignment. */
+interface LyricsAligner {
+  /**
+   * Align [lyrics] (one entry per line) to [phonemeProbabilities], a row-major
+   * `[frames × vocabSize]` matrix of phoneme log-probabilities.
+   *
+   * @param frameDurationMs duration of one frame, usually 20ms.
+   */
+  fun align(
+    lyrics: List<String>,
+    phonemeProbabilities: FloatArray,
+    frameDurationMs: Float,
+    language: Language,
+  ): AlignmentResult
+
+  /**
+   * [align] on log-probabilities in any [FrameMatrix] encoding, so a model that emits FLOAT16 or
+   * INT8 output can be aligned without expanding it. The default expands it to floats;
+   * implementations that read frames directly override it.
+   */
+  fun align(
+    lyrics: List<String>,
+    phonemeLogProbs: FrameMatrix,
+    frameDurationMs: Float,
+    language: Language,
+  ): AlignmentResult = align(lyrics, phonemeLogProbs.toFloatArray(), frameDurationMs, language)
+}
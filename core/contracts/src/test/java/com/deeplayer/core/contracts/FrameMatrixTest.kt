@@ -0,0 +1,105 @@
+package com.deeplayer.core.contracts
+
+import com.google.common.truth.Truth.assertThat
+import kotlin.math.abs
+import kotlin.random.Random
+import org.junit.Test
+
+class FrameMatrixTest {
+
+  @Test
+  fun `floatToHalf rounds to nearest even`() {
+    assertThat(FrameMatrix.floatToHalf(1f)).isEqualTo(0x3C00.toShort())
+    assertThat(FrameMatrix.floatToHalf(-2f)).isEqualTo(0xC000.toShort())
+    assertThat(FrameMatrix.floatToHalf(-0f)).isEqualTo(0x8000.toShort())
+    // 1 + 2^-11 is halfway between 1 and the next half; ties go to the even mantissa.
+    assertThat(FrameMatrix.floatToHalf(1.00048828125f)).isEqualTo(0x3C00.toShort())
+    assertThat(FrameMatrix.floatToHalf(1.00146484375f)).isEqualTo(0x3C02.toShort())
+  }
+
+  @Test
+  fun `floatToHalf handles range limits`() {
+    assertThat(FrameMatrix.floatToHalf(65504f)).isEqualTo(0x7BFF.toShort())
+    assertThat(FrameMatrix.floatToHalf(65520f)).isEqualTo(0x7C00.toShort())
+    assertThat(FrameMatrix.floatToHalf(Float.NEGATIVE_INFINITY)).isEqualTo(0xFC00.toShort())
+    assertThat(FrameMatrix.floatToHalf(5.9604645e-8f)).isEqualTo(0x0001.toShort())
+    assertThat(FrameMatrix.floatToHalf(1e-9f)).isEqualTo(0.toShort())
+    assertThat(FrameMatrix.halfToFloat(FrameMatrix.floatToHalf(Float.NaN)).isNaN()).isTrue()
+  }
+
+  @Test
+  fun `every half survives a round trip`() {
+    for (bits in 0 until 0x10000) {
+      val half = bits.toShort()
+      val value = FrameMatrix.halfToFloat(half)
+      if (value.isNaN()) continue
+      assertThat(FrameMatrix.floatToHalf(value)).isEqualTo(half)
+    }
+  }
+
+  @Test
+  fun `float16 stays within half precision of log-mel values`() {
+    // Log-mel values span the 1e-10 energy floor (about -23) to full scale (about +11).
+    val random = Random(7)
+    val data = FloatArray(98 * 80) { random.nextFloat() * 34f - 23f }
+    val matrix = FrameMatrix.encode(data, 80, FrameFormat.FLOAT16)
+
+    assertThat(matrix.numFrames).isEqualTo(98)
+    assertThat(matrix.sizeInBytes).isEqualTo(data.size * 2L)
+    val decoded = matrix.toFloatArray()
+    for (i in data.indices) {
+      // mel_440hz_ground_truth.json: tolerance_absolute 0.01
+      assertThat(abs(decoded[i] - data[i])).isAtMost(0.01f)
+    }
+  }
+
+  @Test
+  fun `int8 error is at most half a step per frame`() {
+    val random = Random(11)
+    val numColumns = 81
+    val data = FloatArray(200 * numColumns) { -random.nextFloat() * 30f }
+    val matrix = FrameMatrix.encode(data, numColumns, FrameFormat.INT8) as FrameMatrix.Int8
+
+    // One byte per value plus a scale and offset per frame.
+    assertThat(matrix.sizeInBytes).isEqualTo(data.size + matrix.numFrames * 8L)
+    val row = FloatArray(numColumns)
+    for (t in 0 until matrix.numFrames) {
+      matrix.copyFrame(t, row)
+      val tolerance = matrix.scales[t] * 0.5f + 1e-4f
+      for (c in 0 until numColumns) {
+        assertThat(abs(row[c] - data[t * numColumns + c])).isAtMost(tolerance)
+        assertThat(matrix[t, c]).isEqualTo(row[c])
+      }
+    }
+  }
+
+  @Test
+  fun `int8 clamps values far below the frame maximum`() {
+    val data = floatArrayOf(0f, -1f, -1000f, Float.NEGATIVE_INFINITY)
+    val matrix = FrameMatrix.encode(data, 4, FrameFormat.INT8)
+
+    assertThat(matrix[0, 0]).isWithin(1e-5f).of(0f)
+    assertThat(matrix[0, 1]).isWithin(0.13f).of(-1f)
+    assertThat(matrix[0, 2]).isWithin(1e-4f).of(-FrameMatrix.MAX_INT8_RANGE)
+    assertThat(matrix[0, 3]).isWithin(1e-4f).of(-FrameMatrix.MAX_INT8_RANGE)
+  }
+
+  @Test
+  fun `int8 keeps constant and all-infinite frames`() {
+    val negInf = Float.NEGATIVE_INFINITY
+    val data = floatArrayOf(-3f, -3f, -3f, negInf, negInf, negInf)
+    val matrix = FrameMatrix.encode(data, 3, FrameFormat.INT8)
+
+    assertThat(matrix.toFloatArray().toList()).containsExactlyElementsIn(data.toList()).inOrder()
+  }
+
+  @Test
+  fun `float32 wraps data without copying`() {
+    val data = FloatArray(12) { it.toFloat() }
+    val matrix = FrameMatrix.encode(data, 4, FrameFormat.FLOAT32) as FrameMatrix.Float32
+
+    assertThat(matrix.data).isSameInstanceAs(data)
+    assertThat(matrix.numFrames).isEqualTo(3)
+    assertThat(matrix[2, 1]).isEqualTo(9f)
+  }
+}
@@ -9,7 +9,11 @@
   namespace = "com.deeplayer.feature.alignmentorchestrator"
   compileSdk = 35
 
-  defaultConfig { minSdk = 26 }
+  defaultConfig {
+    minSdk = 26
+
+    ndk { abiFilters += listOf("arm64-v8a", "armeabi-v7a") }
+  }
 
   compileOptions {
     sourceCompatibility = JavaVersion.VERSION_17
@@ -18,6 +22,13 @@
 
   kotlinOptions { jvmTarget = "17" }
 
+  externalNativeBuild {
+    cmake {
+      path("src/main/cpp/CMakeLists.txt")
+      version = "3.22.1"
+    }
+  }
+
   testOptions {
     unitTests.all {
       val nativeLib = System.getProperty("whisper.native.lib") ?: ""
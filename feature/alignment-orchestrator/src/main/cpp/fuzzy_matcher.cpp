@@ -0,0 +1,179 @@
+#include "fuzzy_matcher.h"
+
+#include <algorithm>
+
+namespace deeplayer {
+
+namespace {
+
+constexpr uint32_t kEmptySlot = 0xFFFFFFFFu;
+
+// Matches the characters left by TranscriptionLyricsMatcher.normalise() that
+// Kotlin's trim() removes: after stripping [^\p{L}\p{N}\s] only \s remains.
+inline bool is_trim_space(uint16_t c) {
+  return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+inline float similarity(int distance, int candidate_length, int line_length) {
+  int max_len = std::max(candidate_length, line_length);
+  if (max_len == 0) return 1.0f;
+  return 1.0f - static_cast<float>(distance) / static_cast<float>(max_len);
+}
+
+}  // namespace
+
+FuzzyMatcher::FuzzyMatcher(int max_pattern_length) {
+  reserve(max_pattern_length);
+}
+
+FuzzyMatcher::~FuzzyMatcher() = default;
+
+void FuzzyMatcher::reserve(int max_pattern_length) {
+  int blocks = std::max(1, (max_pattern_length + kWordBits - 1) / kWordBits);
+  uint32_t slots = 64;
+  while (slots < static_cast<uint32_t>(max_pattern_length) * 2) slots <<= 1;
+
+  if (slots > slot_keys_.size()) {
+    slot_keys_.resize(slots);
+    slot_rows_.resize(slots);
+  }
+  size_t peq_size = static_cast<size_t>(std::max(1, max_pattern_length)) * blocks;
+  if (peq_size > peq_.size()) peq_.resize(peq_size);
+  if (static_cast<size_t>(blocks) > zero_row_.size()) {
+    zero_row_.assign(blocks, 0);
+    pv_.resize(blocks);
+    mv_.resize(blocks);
+  }
+}
+
+void FuzzyMatcher::set_pattern(const uint16_t* pattern, int length) {
+  reserve(length);
+  pattern_length_ = length;
+  num_blocks_ = std::max(1, (length + kWordBits - 1) / kWordBits);
+  last_block_high_bit_ =
+      length > 0 ? uint64_t{1} << ((length - 1) % kWordBits) : 0;
+
+  uint32_t slots = 64;
+  while (slots < static_cast<uint32_t>(length) * 2) slots <<= 1;
+  slot_mask_ = slots - 1;
+  std::fill(slot_keys_.begin(), slot_keys_.begin() + slots, kEmptySlot);
+
+  int rows = 0;
+  for (int i = 0; i < length; i++) {
+    uint16_t c = pattern[i];
+    uint32_t slot = (c * 0x9E3779B1u) >> 16 & slot_mask_;
+    while (slot_keys_[slot] != kEmptySlot && slot_keys_[slot] != c) {
+      slot = (slot + 1) & slot_mask_;
+    }
+    if (slot_keys_[slot] == kEmptySlot) {
+      slot_keys_[slot] = c;
+      slot_rows_[slot] = rows;
+      std::fill(peq_.begin() + static_cast<size_t>(rows) * num_blocks_,
+                peq_.begin() + static_cast<size_t>(rows + 1) * num_blocks_, 0);
+      rows++;
+    }
+    uint64_t* row = &peq_[static_cast<size_t>(slot_rows_[slot]) * num_blocks_];
+    row[i / kWordBits] |= uint64_t{1} << (i % kWordBits);
+  }
+
+  reset();
+}
+
+void FuzzyMatcher::reset() {
+  std::fill(pv_.begin(), pv_.begin() + num_blocks_, ~uint64_t{0});
+  std::fill(mv_.begin(), mv_.begin() + num_blocks_, 0);
+  score_ = pattern_length_;
+}
+
+const uint64_t* FuzzyMatcher::lookup(uint16_t c) const {
+  uint32_t slot = (c * 0x9E3779B1u) >> 16 & slot_mask_;
+  while (slot_keys_[slot] != kEmptySlot) {
+    if (slot_keys_[slot] == c) {
+      return &peq_[static_cast<size_t>(slot_rows_[slot]) * num_blocks_];
+    }
+    slot = (slot + 1) & slot_mask_;
+  }
+  return zero_row_.data();
+}
+
+int FuzzyMatcher::advance(uint16_t c) {
+  if (pattern_length_ == 0) return ++score_;
+
+  const uint64_t* eq_row = lookup(c);
+  // Top row of the DP is D[0][j] = j, so every column enters with +1.
+  int h_in = 1;
+  for (int b = 0; b < num_blocks_; b++) {
+    uint64_t pv = pv_[b];
+    uint64_t mv = mv_[b];
+    uint64_t eq = eq_row[b];
+    uint64_t high_bit =
+        b == num_blocks_ - 1 ? last_block_high_bit_ : uint64_t{1} << 63;
+
+    uint64_t xv = eq | mv;
+    if (h_in < 0) eq |= 1;
+    uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+
+    int h_out = 0;
+    if (ph & high_bit) {
+      h_out = 1;
+    } else if (mh & high_bit) {
+      h_out = -1;
+    }
+
+    ph <<= 1;
+    mh <<= 1;
+    if (h_in < 0) {
+      mh |= 1;
+    } else if (h_in > 0) {
+      ph |= 1;
+    }
+    pv_[b] = mh | ~(xv | ph);
+    mv_[b] = ph & xv;
+    h_in = h_out;
+  }
+  score_ += h_in;
+  return score_;
+}
+
+WindowScorer::WindowScorer(const uint16_t* pieces, const int* piece_offsets,
+                           int num_pieces, bool join_with_space)
+    : pieces_(pieces, pieces + (num_pieces > 0 ? piece_offsets[num_pieces] : 0)),
+      piece_offsets_(piece_offsets, piece_offsets + std::max(0, num_pieces) + 1),
+      num_pieces_(std::max(0, num_pieces)),
+      join_with_space_(join_with_space) {}
+
+int WindowScorer::score(const uint16_t* line, int line_length, int start,
+                        int max_count, float* out) {
+  if (start < 0 || start >= num_pieces_ || max_count <= 0) return 0;
+  int windows = std::min(max_count, num_pieces_ - start);
+  matcher_.set_pattern(line, line_length);
+
+  // Candidate text is trimmed: skip leading spaces, and report the distance
+  // as of the last non-space unit consumed.
+  int consumed = 0;
+  int trimmed_length = 0;
+  int trimmed_score = line_length;
+  for (int count = 0; count < windows; count++) {
+    int p = start + count;
+    if (count > 0 && join_with_space_ && consumed > 0) {
+      matcher_.advance(' ');
+      consumed++;
+    }
+    for (int i = piece_offsets_[p]; i < piece_offsets_[p + 1]; i++) {
+      uint16_t c = pieces_[i];
+      if (consumed == 0 && is_trim_space(c)) continue;
+      matcher_.advance(c);
+      consumed++;
+      if (!is_trim_space(c)) {
+        trimmed_length = consumed;
+        trimmed_score = matcher_.score();
+      }
+    }
+    out[count] = similarity(trimmed_score, trimmed_length, line_length);
+  }
+  return windows;
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace deeplayer {
+
+/**
+ * Bit-parallel edit distance (Myers 1999, block form by Hyyro 2003) for
+ * matching transcription segments against lyrics lines.
+ *
+ * Strings are UTF-16 code units, the same units Kotlin's String.length and
+ * indexing use, so distances are identical to the Kotlin Levenshtein DP.
+ */
+class FuzzyMatcher {
+ public:
+  /**
+   * @param max_pattern_length Longest pattern this matcher will be given.
+   *                           Buffers are sized once so set_pattern() and
+   *                           advance() never allocate below this length.
+   */
+  explicit FuzzyMatcher(int max_pattern_length = 256);
+  ~FuzzyMatcher();
+
+  FuzzyMatcher(const FuzzyMatcher&) = delete;
+  FuzzyMatcher& operator=(const FuzzyMatcher&) = delete;
+
+  /** Prepare the match bit-vectors for a new pattern and reset the scan. */
+  void set_pattern(const uint16_t* pattern, int length);
+
+  /** Restart the scan against the current pattern (empty text). */
+  void reset();
+
+  /**
+   * Append one text code unit.
+   * @return Edit distance between the pattern and all text consumed so far.
+   */
+  int advance(uint16_t c);
+
+  /** Edit distance between the pattern and all text consumed so far. */
+  int score() const { return score_; }
+
+  int pattern_length() const { return pattern_length_; }
+
+ private:
+  static constexpr int kWordBits = 64;
+
+  int pattern_length_ = 0;
+  int num_blocks_ = 0;
+  int score_ = 0;
+  uint64_t last_block_high_bit_ = 0;
+
+  // Open-addressing table: code unit -> row in peq_. Slot 0xFFFFFFFF is empty.
+  std::vector<uint32_t> slot_keys_;
+  std::vector<int> slot_rows_;
+  uint32_t slot_mask_ = 0;
+  // peq_[row * num_blocks_ + b]: bits set where the pattern equals that unit.
+  std::vector<uint64_t> peq_;
+  std::vector<uint64_t> zero_row_;
+  std::vector<uint64_t> pv_;
+  std::vector<uint64_t> mv_;
+
+  void reserve(int max_pattern_length);
+  const uint64_t* lookup(uint16_t c) const;
+};
+
+/**
+ * Scores windows of consecutive pieces against lyrics lines, one start index
+ * at a time. The greedy segment assignment only ever reads the windows that
+ * begin at its current segment, so nothing else is computed.
+ *
+ * The candidate for (start, count) is pieces[start .. start+count-1] joined
+ * with a single space if join_with_space, otherwise concatenated, then
+ * trimmed of leading/trailing ASCII whitespace. Its similarity to a line is
+ * `1 - distance / max(len(candidate), len(line))` (1 when both are empty).
+ */
+class WindowScorer {
+ public:
+  /**
+   * @param pieces          UTF-16 units of all normalised pieces, concatenated.
+   * @param piece_offsets   num_pieces + 1 offsets into pieces.
+   * @param join_with_space Whether pieces are separated by ' '.
+   */
+  WindowScorer(const uint16_t* pieces, const int* piece_offsets, int num_pieces,
+               bool join_with_space);
+
+  WindowScorer(const WindowScorer&) = delete;
+  WindowScorer& operator=(const WindowScorer&) = delete;
+
+  int num_pieces() const { return num_pieces_; }
+
+  /**
+   * Score the windows starting at piece `start` against one line.
+   * @param out Receives the similarity of the window of count pieces at
+   *            out[count - 1], for count = 1 .. the returned value.
+   * @return min(max_count, num_pieces - start), or 0 if start is out of range.
+   */
+  int score(const uint16_t* line, int line_length, int start, int max_count,
+            float* out);
+
+ private:
+  std::vector<uint16_t> pieces_;
+  std::vector<int> piece_offsets_;
+  int num_pieces_;
+  bool join_with_space_;
+  FuzzyMatcher matcher_;
+};
+
+}  // namespace deeplayer
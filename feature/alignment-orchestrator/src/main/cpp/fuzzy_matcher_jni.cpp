@@ -0,0 +1,79 @@
+#include <jni.h>
+
+#include <new>
+#include <vector>
+
+#include "fuzzy_matcher.h"
+
+extern "C" {
+
+JNIEXPORT jlong JNICALL
+Java_com_deeplayer_feature_alignmentorchestrator_NativeFuzzyMatcher_nativeCreate(
+    JNIEnv* env, jobject /* thiz */, jcharArray pieceChars, jintArray pieceOffsets,
+    jboolean joinWithSpace) {
+  jsize num_pieces = env->GetArrayLength(pieceOffsets) - 1;
+  if (num_pieces < 0) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  "pieceOffsets must hold num_pieces + 1 entries");
+    return 0;
+  }
+
+  std::vector<uint16_t> pieces(env->GetArrayLength(pieceChars));
+  std::vector<int> piece_offsets(num_pieces + 1);
+  env->GetCharArrayRegion(pieceChars, 0, static_cast<jsize>(pieces.size()),
+                          reinterpret_cast<jchar*>(pieces.data()));
+  env->GetIntArrayRegion(pieceOffsets, 0, num_pieces + 1,
+                         reinterpret_cast<jint*>(piece_offsets.data()));
+  if (piece_offsets[num_pieces] > static_cast<int>(pieces.size())) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  "pieceOffsets run past pieceChars");
+    return 0;
+  }
+
+  auto* scorer = new (std::nothrow) deeplayer::WindowScorer(
+      pieces.data(), piece_offsets.data(), num_pieces, joinWithSpace == JNI_TRUE);
+  if (!scorer) {
+    env->ThrowNew(env->FindClass("java/lang/OutOfMemoryError"),
+                  "Failed to allocate window scorer");
+    return 0;
+  }
+  return reinterpret_cast<jlong>(scorer);
+}
+
+JNIEXPORT void JNICALL
+Java_com_deeplayer_feature_alignmentorchestrator_NativeFuzzyMatcher_nativeDestroy(
+    JNIEnv* /* env */, jobject /* thiz */, jlong handle) {
+  delete reinterpret_cast<deeplayer::WindowScorer*>(handle);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_deeplayer_feature_alignmentorchestrator_NativeFuzzyMatcher_nativeScore(
+    JNIEnv* env, jobject /* thiz */, jlong handle, jstring line, jint start,
+    jint maxCount, jfloatArray out) {
+  auto* scorer = reinterpret_cast<deeplayer::WindowScorer*>(handle);
+  if (env->GetArrayLength(out) < maxCount) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  "Output array shorter than maxCount");
+    return 0;
+  }
+
+  // One line against at most maxCount windows is a few microseconds of
+  // work, so score straight out of and into the pinned Java arrays.
+  jsize line_length = env->GetStringLength(line);
+  const jchar* line_chars = env->GetStringCritical(line, nullptr);
+  if (!line_chars) return 0;
+  auto* scores = static_cast<float*>(env->GetPrimitiveArrayCritical(out, nullptr));
+  if (!scores) {
+    env->ReleaseStringCritical(line, line_chars);
+    return 0;
+  }
+
+  int written = scorer->score(reinterpret_cast<const uint16_t*>(line_chars),
+                              line_length, start, maxCount, scores);
+
+  env->ReleasePrimitiveArrayCritical(out, scores, 0);
+  env->ReleaseStringCritical(line, line_chars);
+  return written;
+}
+
+}  // extern "C"
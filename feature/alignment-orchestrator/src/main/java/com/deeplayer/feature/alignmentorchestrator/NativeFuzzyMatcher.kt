@@ -0,0 +1,78 @@
+package com.deeplayer.feature.alignmentorchestrator
+
+/**
+ * JNI bindings for the bit-parallel edit-distance scorer in fuzzy_matcher.cpp.
+ *
+ * There is no batch entry point that scores every line x window pair, and nothing runs on extra
+ * threads. The greedy assignment in TranscriptionLyricsMatcher reads only the windows that start
+ * at its current segment, one row per line, so a full table would be computed and thrown away.
+ * Each call is a few microseconds of single-threaded work on the caller's thread.
+ *
+ * Distances count UTF-16 code units, not code points, because the Kotlin Levenshtein fallback
+ * does. A character outside the BMP is two units on both sides, so scores still match exactly.
+ *
+ * The native library is optional: [isAvailable] is false on the JVM (unit tests) or if the
+ * library failed to load, and callers fall back to the Kotlin implementation.
+ */
+internal object NativeFuzzyMatcher {
+
+  val isAvailable: Boolean =
+    try {
+      System.loadLibrary("fuzzy_matcher")
+      true
+    } catch (e: UnsatisfiedLinkError) {
+      false
+    }
+
+  /**
+   * Native scorer for windows of consecutive [pieces]. Windows are scored one start index at a
+   * time, so only the windows a caller reads are computed. Must be [close]d.
+   *
+   * @param joinWithSpace join pieces with a single space (then trim) instead of concatenating.
+   */
+  class WindowScorer(pieces: List<String>, joinWithSpace: Boolean) : AutoCloseable {
+    private var handle: Long
+
+    init {
+      val offsets = IntArray(pieces.size + 1)
+      for ((i, s) in pieces.withIndex()) offsets[i + 1] = offsets[i] + s.length
+      val chars = CharArray(offsets.last())
+      for ((i, s) in pieces.withIndex()) s.toCharArray(chars, offsets[i])
+      handle = nativeCreate(chars, offsets, joinWithSpace)
+    }
+
+    /**
+     * Similarities of [line] to the windows starting at piece [start]: `out[count - 1]` holds the
+     * window of `count` pieces, for `count` up to `out.size`.
+     *
+     * @return the number of windows written, fewer than `out.size` near the last piece.
+     */
+    fun score(line: String, start: Int, out: FloatArray): Int {
+      check(handle != 0L) { "WindowScorer is closed" }
+      return nativeScore(handle, line, start, out.size, out)
+    }
+
+    override fun close() {
+      if (handle != 0L) {
+        nativeDestroy(handle)
+        handle = 0L
+      }
+    }
+  }
+
+  private external fun nativeCreate(
+    pieceChars: CharArray,
+    pieceOffsets: IntArray,
+    joinWithSpace: Boolean,
+  ): Long
+
+  private external fun nativeDestroy(handle: Long)
+
+  private external fun nativeScore(
+    handle: Long,
+    line: String,
+    start: Int,
+    maxCount: Int,
+    out: FloatArray,
+  ): Int
+}
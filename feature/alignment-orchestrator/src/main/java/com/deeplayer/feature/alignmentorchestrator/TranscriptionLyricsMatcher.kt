@@ -13,7 +13,8 @@
  * 1. Normalise both transcribed text and lyrics (strip whitespace for Korean, lowercase for
  *    English).
  * 2. Monotonic sequential matching: greedily assign contiguous transcription segments to each
- *    lyrics line, choosing the assignment that maximises Levenshtein similarity.
+ *    lyrics line, choosing the assignment that maximises Levenshtein similarity. Window scores come
+ *    from [NativeFuzzyMatcher] (bit-parallel) when the native library is loaded.
  * 3. Un-matched lyrics lines receive interpolated timestamps from their neighbours.
  * 4. Per-word timestamps within a line are distributed evenly across the line duration.
  */
@@ -106,6 +107,19 @@ private fun assignSegmentsToLines(
     val result = MutableList<MutableList<TranscribedSegment>>(normLyrics.size) { mutableListOf() }
     if (segments.isEmpty()) return result
 
+    val pieces = segments.map { normalisePiece(it.text, language) }
+    windowScores(normLyrics, pieces, language).use { scores ->
+      assignGreedily(scores, segments, normLyrics, result)
+    }
+    return result
+  }
+
+  private fun assignGreedily(
+    scores: WindowScores,
+    segments: List<TranscribedSegment>,
+    normLyrics: List<String>,
+    result: List<MutableList<TranscribedSegment>>,
+  ) {
     var segIdx = 0
     for (lineIdx in normLyrics.indices) {
       if (segIdx >= segments.size) break
@@ -115,14 +129,10 @@ private fun assignSegmentsToLines(
       // Try consuming 1..maxSegments segments and pick the best match
       var bestSim = -1f
       var bestCount = 0
-      val maxLookahead = minOf(segments.size - segIdx, 20) // cap lookahead
+      val maxLookahead = minOf(segments.size - segIdx, MAX_LOOKAHEAD) // cap lookahead
 
-      val builder = StringBuilder()
       for (count in 1..maxLookahead) {
-        val seg = segments[segIdx + count - 1]
-        if (builder.isNotEmpty()) builder.append(' ')
-        builder.append(seg.text.trim())
-        val sim = levenshteinSimilarity(normalise(builder.toString(), language), target)
+        val sim = scores.similarity(lineIdx, segIdx, count)
         if (sim > bestSim) {
           bestSim = sim
           bestCount = count
@@ -140,8 +150,55 @@ private fun assignSegmentsToLines(
         segIdx += bestCount
       }
     }
+  }
 
-    return result
+  /**
+   * Similarity of lyrics line `line` to the window of `count` segments starting at `start`. The
+   * window text is `normalise(segments joined with ' ')`, assembled from per-segment pieces.
+   */
+  private interface WindowScores : AutoCloseable {
+    fun similarity(line: Int, start: Int, count: Int): Float
+
+    override fun close() {}
+  }
+
+  /**
+   * Scores windows with the native bit-parallel matcher when it is loaded, otherwise in Kotlin.
+   * Both score on demand: the greedy assignment reads only the windows starting at its current
+   * segment, so the native scorer computes that one row per line and serves each count from it.
+   */
+  private fun windowScores(
+    normLyrics: List<String>,
+    pieces: List<String>,
+    language: Language,
+  ): WindowScores {
+    val joinWithSpace = language == Language.EN
+    if (NativeFuzzyMatcher.isAvailable) {
+      val scorer = NativeFuzzyMatcher.WindowScorer(pieces, joinWithSpace)
+      return object : WindowScores {
+        private val row = FloatArray(MAX_LOOKAHEAD)
+        private var rowLine = -1
+        private var rowStart = -1
+
+        override fun similarity(line: Int, start: Int, count: Int): Float {
+          if (line != rowLine || start != rowStart) {
+            scorer.score(normLyrics[line], start, row)
+            rowLine = line
+            rowStart = start
+          }
+          return row[count - 1]
+        }
+
+        override fun close() = scorer.close()
+      }
+    }
+    val separator = if (joinWithSpace) " " else ""
+    return object : WindowScores {
+      override fun similarity(line: Int, start: Int, count: Int): Float {
+        val window = pieces.subList(start, start + count).joinToString(separator).trim()
+        return levenshteinSimilarity(window, normLyrics[line])
+      }
+    }
   }
 
   /** Distribute words evenly across the line's time span. */
@@ -245,6 +302,19 @@ internal fun normalise(text: String, language: Language): String {
     }
   }
 
+  /**
+   * Normalise one segment so that joining pieces (with ' ' for English, directly otherwise) and
+   * trimming gives the same string as [normalise] on the joined segment texts.
+   */
+  internal fun normalisePiece(text: String, language: Language): String {
+    val stripped = text.trim().replace(Regex("[^\\p{L}\\p{N}\\s]"), "")
+    return when (language) {
+      Language.KO -> stripped.replace(Regex("\\s+"), "")
+      Language.EN -> stripped.lowercase()
+      Language.MIXED -> stripped.replace(Regex("\\s+"), "").lowercase()
+    }
+  }
+
   internal fun levenshteinSimilarity(a: String, b: String): Float {
     if (a == b) return 1f
     val maxLen = maxOf(a.length, b.length)
@@ -267,6 +337,8 @@ private fun levenshteinDistance(a: String, b: String): Int {
     return dp[m][n]
   }
 
+  private const val MAX_LOOKAHEAD = 20
+
   private fun buildEnhancedLrc(lines: List<LineAlignment>): String = buildString {
     for (line in lines) {
       val mins = line.startMs / 60000
@@ -0,0 +1,162 @@
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "fuzzy_matcher.h"
+#include "native_test.h"
+
+namespace {
+
+using Units = std::u16string;
+
+// TranscriptionLyricsMatcher.levenshteinDistance: the plain DP.
+int levenshtein(const Units& a, const Units& b) {
+  std::vector<int> prev(b.size() + 1), cur(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); j++) prev[j] = static_cast<int>(j);
+  for (size_t i = 1; i <= a.size(); i++) {
+    cur[0] = static_cast<int>(i);
+    for (size_t j = 1; j <= b.size(); j++) {
+      int cost = a[i - 1] == b[j - 1] ? 0 : 1;
+      cur[j] = std::min({prev[j] + 1, cur[j - 1] + 1, prev[j - 1] + cost});
+    }
+    std::swap(prev, cur);
+  }
+  return prev[b.size()];
+}
+
+// TranscriptionLyricsMatcher.levenshteinSimilarity.
+float similarity(const Units& a, const Units& b) {
+  if (a == b) return 1.0f;
+  size_t max_len = std::max(a.size(), b.size());
+  if (max_len == 0) return 1.0f;
+  return 1.0f - static_cast<float>(levenshtein(a, b)) / static_cast<float>(max_len);
+}
+
+bool is_space(char16_t c) { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+Units trim(const Units& s) {
+  size_t begin = 0;
+  size_t end = s.size();
+  while (begin < end && is_space(s[begin])) begin++;
+  while (end > begin && is_space(s[end - 1])) end--;
+  return s.substr(begin, end - begin);
+}
+
+// The Kotlin fallback: pieces.subList(start, start + count).joinToString(sep).trim()
+Units window(const std::vector<Units>& pieces, int start, int count,
+             bool join_with_space) {
+  Units joined;
+  for (int i = start; i < start + count; i++) {
+    if (i > start && join_with_space) joined += u' ';
+    joined += pieces[i];
+  }
+  return trim(joined);
+}
+
+struct Packed {
+  std::vector<uint16_t> units;
+  std::vector<int> offsets{0};
+};
+
+Packed pack(const std::vector<Units>& pieces) {
+  Packed packed;
+  for (const auto& p : pieces) {
+    packed.units.insert(packed.units.end(), p.begin(), p.end());
+    packed.offsets.push_back(static_cast<int>(packed.units.size()));
+  }
+  return packed;
+}
+
+void check_against_reference(const std::vector<Units>& lines,
+                             const std::vector<Units>& pieces, bool join_with_space,
+                             int max_count, const char* label) {
+  Packed packed = pack(pieces);
+  deeplayer::WindowScorer scorer(packed.units.data(), packed.offsets.data(),
+                                 static_cast<int>(pieces.size()), join_with_space);
+  std::vector<float> out(max_count);
+  for (size_t l = 0; l < lines.size(); l++) {
+    const auto* line = reinterpret_cast<const uint16_t*>(lines[l].data());
+    for (int start = 0; start < static_cast<int>(pieces.size()); start++) {
+      int written = scorer.score(line, static_cast<int>(lines[l].size()), start,
+                                 max_count, out.data());
+      int expected_windows =
+          std::min(max_count, static_cast<int>(pieces.size()) - start);
+      EXPECT(written == expected_windows, "%s: line %zu start %d wrote %d", label, l,
+             start, written);
+      for (int count = 1; count <= written; count++) {
+        float expected =
+            similarity(window(pieces, start, count, join_with_space), lines[l]);
+        EXPECT(out[count - 1] == expected, "%s: line %zu start %d count %d: %f vs %f",
+               label, l, start, count, out[count - 1], expected);
+      }
+    }
+  }
+}
+
+Units random_units(std::mt19937& rng, size_t length, const Units& alphabet) {
+  Units s(length, u' ');
+  std::uniform_int_distribution<size_t> pick(0, alphabet.size() - 1);
+  for (auto& c : s) c = alphabet[pick(rng)];
+  return s;
+}
+
+void test_edge_cases() {
+  std::vector<Units> lines = {u"", u"hello world", u"a"};
+  std::vector<Units> pieces = {u"", u"hello", u"", u"  ", u"world", u"x", u""};
+  check_against_reference(lines, pieces, true, 20, "edge/space");
+  check_against_reference(lines, pieces, false, 20, "edge/concat");
+
+  // Everything empty: similarity 1 by definition.
+  check_against_reference({u""}, {u"", u""}, true, 4, "edge/empty");
+}
+
+void test_out_of_range_start() {
+  std::vector<Units> pieces = {u"ab", u"cd"};
+  Packed packed = pack(pieces);
+  deeplayer::WindowScorer scorer(packed.units.data(), packed.offsets.data(), 2, true);
+  const Units line = u"ab cd";
+  const auto* units = reinterpret_cast<const uint16_t*>(line.data());
+  float out[4] = {-1, -1, -1, -1};
+  EXPECT(scorer.score(units, 5, 2, 4, out) == 0, "start == num_pieces");
+  EXPECT(scorer.score(units, 5, -1, 4, out) == 0, "negative start");
+  EXPECT(scorer.score(units, 5, 0, 0, out) == 0, "max_count 0");
+  EXPECT(out[0] == -1, "out written for empty range");
+  EXPECT(scorer.score(units, 5, 0, 4, out) == 2, "windows past the last piece");
+  EXPECT(out[1] == 1.0f, "exact window: %f", out[1]);
+}
+
+void test_random(bool join_with_space) {
+  std::mt19937 rng(join_with_space ? 1 : 2);
+  // Few distinct units so that windows share substrings with the lines.
+  const Units latin = u"abcde \t";
+  const Units hangul = u"가각나다라";
+  for (int round = 0; round < 20; round++) {
+    const Units& alphabet = round % 2 ? hangul : latin;
+    std::uniform_int_distribution<size_t> piece_length(0, round < 10 ? 12 : 40);
+    std::vector<Units> pieces(12);
+    for (auto& p : pieces) p = random_units(rng, piece_length(rng), alphabet);
+
+    // Lines up to 200 units run the multi-block (> 64 and > 128) paths.
+    std::vector<Units> lines;
+    for (size_t length : {size_t{0}, size_t{7}, size_t{63}, size_t{64}, size_t{65},
+                          size_t{130}, size_t{200}}) {
+      lines.push_back(random_units(rng, length, alphabet));
+    }
+    // And one line that is exactly a window, to hit the similarity-1 case.
+    lines.push_back(window(pieces, 3, 4, join_with_space));
+    check_against_reference(lines, pieces, join_with_space, 20,
+                            join_with_space ? "random/space" : "random/concat");
+  }
+}
+
+}  // namespace
+
+int main() {
+  test_edge_cases();
+  test_out_of_range_start();
+  test_random(true);
+  test_random(false);
+  return native_test::finish("fuzzy_matcher_test");
+}
@@ -175,4 +175,43 @@ fun `multi-segment lyrics line consumes multiple transcription segments`() {
     assertThat(result.lines[1].startMs).isEqualTo(2000)
     assertThat(result.lines[1].endMs).isEqualTo(3000)
   }
+
+  @Test
+  fun `joined pieces equal normalise of joined segment text`() {
+    val texts = listOf(" Hello,", "! world ", "...", "it's  ME", "", "나는 학생", "입니다!")
+    for (language in Language.entries) {
+      val separator = if (language == Language.EN) " " else ""
+      val pieces = texts.map { TranscriptionLyricsMatcher.normalisePiece(it, language) }
+      for (start in texts.indices) {
+        for (end in start + 1..texts.size) {
+          val joined = texts.subList(start, end).joinToString(" ") { it.trim() }
+          val expected = TranscriptionLyricsMatcher.normalise(joined, language)
+          val actual = pieces.subList(start, end).joinToString(separator).trim()
+          assertThat(actual).isEqualTo(expected)
+        }
+      }
+    }
+  }
+
+  @Test
+  fun `repeated chorus lines consume segments in order`() {
+    val chorus = listOf("la la love", "you and me")
+    val segments =
+      (0 until 3).flatMap { rep ->
+        val t = rep * 4000L
+        listOf(
+          TranscribedSegment(text = "La la", startMs = t, endMs = t + 1000),
+          TranscribedSegment(text = "love,", startMs = t + 1000, endMs = t + 2000),
+          TranscribedSegment(text = "you and me", startMs = t + 2000, endMs = t + 4000),
+        )
+      }
+    val lyrics = chorus + chorus + chorus
+
+    val result = TranscriptionLyricsMatcher.match(segments, lyrics, Language.EN)
+
+    assertThat(result.lines.map { it.startMs })
+      .containsExactly(0L, 2000L, 4000L, 6000L, 8000L, 10000L)
+      .inOrder()
+    assertThat(result.overallConfidence).isEqualTo(1f)
+  }
 }
@@ -0,0 +1,94 @@
+package com.deeplayer.feature.alignmentorchestrator
+
+import com.deeplayer.core.contracts.Language
+import com.deeplayer.feature.inferenceengine.InferenceThreadPolicy
+import com.deeplayer.feature.inferenceengine.WhisperCppTranscriber
+import java.io.File
+import java.nio.ByteBuffer
+import java.nio.ByteOrder
+import org.junit.Assume.assumeTrue
+import org.junit.Test
+
+/**
+ * Benchmarks Whisper transcription on every ggml CPU kernel variant compiled into the native
+ * library. Variants the host CPU does not support are reported and skipped.
+ *
+ * Run via: ./scripts/bench_whisper_variants.sh <audio_file> [language]
+ *
+ * Uses the same system properties as [PipelineIntegrationTest] (whisper.native.lib,
+ * whisper.model.path, whisper.pcm.path, whisper.language).
+ */
+class WhisperCpuVariantBenchmarkTest {
+
+  @Test
+  fun `benchmark every cpu variant`() {
+    val nativeLib = System.getProperty("whisper.native.lib")
+    val modelPath = System.getProperty("whisper.model.path")
+    val pcmPath = System.getProperty("whisper.pcm.path")
+    val language = System.getProperty("whisper.language") ?: "ko"
+
+    // Skip gracefully if not configured (normal ./gradlew test)
+    assumeTrue(
+      "Skipping: whisper.native.lib not set (run via scripts/bench_whisper_variants.sh)",
+      !nativeLib.isNullOrBlank(),
+    )
+    assumeTrue("Skipping: whisper.model.path not set", !modelPath.isNullOrBlank())
+    assumeTrue("Skipping: whisper.pcm.path not set", !pcmPath.isNullOrBlank())
+    assumeTrue("Native library not found: $nativeLib", File(nativeLib!!).exists())
+    assumeTrue("Model file not found: $modelPath", File(modelPath!!).exists())
+    assumeTrue("PCM file not found: $pcmPath", File(pcmPath!!).exists())
+
+    // One Whisper window is enough to compare kernels
+    val pcm = readPcmFile(File(pcmPath)).let { it.copyOf(minOf(it.size, 30 * 16000)) }
+    val lang =
+      when (language.lowercase()) {
+        "en" -> Language.EN
+        "mixed" -> Language.MIXED
+        else -> Language.KO
+      }
+
+    val autoSelected = WhisperCppTranscriber.cpuVariant()
+    println("=== Auto-selected CPU variant: $autoSelected ===")
+
+    // Same fixed thread count for every variant, and no background calibration competing with
+    // the timed runs.
+    val threadPolicy = InferenceThreadPolicy(calibrate = false)
+
+    val report = buildString {
+      appendLine("=== CPU variant benchmark (${pcm.size / 16000}s audio) ===")
+      for (variant in WhisperCppTranscriber.cpuVariants()) {
+        if (WhisperCppTranscriber.selectCpuVariant(variant) == null) {
+          appendLine("  %-24s unsupported".format(variant))
+          continue
+        }
+        val transcriber = WhisperCppTranscriber(threadPolicy)
+        try {
+          check(transcriber.loadModel(modelPath)) { "Failed to load whisper model: $modelPath" }
+          transcriber.transcribe(pcm, lang) // warm-up
+          val runs = 3
+          val startNs = System.nanoTime()
+          var segments = 0
+          repeat(runs) { segments = transcriber.transcribe(pcm, lang).size }
+          val avgMs = (System.nanoTime() - startNs) / runs / 1_000_000
+          val marker = if (variant == autoSelected) " (auto)" else ""
+          appendLine("  %-24s %6d ms  %d segments%s".format(variant, avgMs, segments, marker))
+        } finally {
+          transcriber.close()
+        }
+      }
+    }
+    WhisperCppTranscriber.selectCpuVariant(null)
+
+    println(report)
+    File(File(nativeLib).parentFile, "cpu_variant_benchmark.txt").writeText(report)
+  }
+
+  /** Read raw f32le PCM file into FloatArray. */
+  private fun readPcmFile(file: File): FloatArray {
+    val bytes = file.readBytes()
+    val buffer = ByteBuffer.wrap(bytes).order(ByteOrder.LITTLE_ENDIAN)
+    val floats = FloatArray(bytes.size / 4)
+    buffer.asFloatBuffer().get(floats)
+    return floats
+  }
+}
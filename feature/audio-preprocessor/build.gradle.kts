@@ -10,24 +10,27 @@
   defaultConfig {
     minSdk = 26
 
+    externalNativeBuild { cmake { arguments("-DANDROID_STL=c++_shared") } }
+
     ndk { abiFilters += listOf("arm64-v8a", "armeabi-v7a") }
   }
 
-  // Native build requires FFmpeg pre-built libraries.
-  // Uncomment when FFmpeg libs are available under src/main/jniLibs/.
-  // externalNativeBuild {
-  //   cmake {
-  //     path = file("src/main/cpp/CMakeLists.txt")
-  //     version = "3.22.1"
-  //   }
-  // }
-
   compileOptions {
     sourceCompatibility = JavaVersion.VERSION_17
     targetCompatibility = JavaVersion.VERSION_17
   }
 
   kotlinOptions { jvmTarget = "17" }
+
+  // FFmpeg is optional: CMake links the pre-built libraries when it finds them, otherwise the
+  // native decoder handles uncompressed WAV/AIFF only and NativeAudioPreprocessor falls back to
+  // the platform decoder for everything else.
+  externalNativeBuild {
+    cmake {
+      path("src/main/cpp/CMakeLists.txt")
+      version = "3.22.1"
+    }
+  }
 }
 
 dependencies {
@@ -1,16 +1,22 @@
 #include "audio_decoder.h"
 
 #include <android/log.h>
+#include <unistd.h>
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <stdexcept>
 
+#include "pcm_file_decoder.h"
+
+#if HAS_FFMPEG
 extern "C" {
 #include <libavcodec/avcodec.h>
 #include <libavformat/avformat.h>
 #include <libswresample/swresample.h>
 }
+#endif
 
 #define LOG_TAG "AudioDecoder"
 #define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, LOG_TAG, __VA_ARGS__)
@@ -18,6 +24,39 @@ extern "C" {
 
 namespace deeplayer {
 
+AudioDecoder::AudioDecoder() = default;
+AudioDecoder::~AudioDecoder() = default;
+
+PcmResult AudioDecoder::decode(const std::string& file_path, size_t max_samples) {
+  PcmFile pcm_file;
+  if (pcm_file.open(file_path, kTargetSampleRate)) return decode(pcm_file, max_samples);
+  return PcmResult{
+      .data = decode_with_ffmpeg(file_path, max_samples),
+      .sample_rate = kTargetSampleRate,
+      .channels = kTargetChannels,
+  };
+}
+
+PcmResult AudioDecoder::decode(const PcmFile& file, size_t max_samples) {
+  if (file.target_rate() != kTargetSampleRate) {
+    throw std::invalid_argument("PcmFile not opened at the target rate: " + file.path());
+  }
+  if (file.output_size() > max_samples) {
+    throw DecodeLimitError("Decoded audio exceeds the sample limit: " + file.path());
+  }
+  std::vector<float> pcm_data;
+  file.decode(&pcm_data);
+  LOGI("Decoded %zu samples at %dHz mono from %s (PCM fast path)", pcm_data.size(),
+       kTargetSampleRate, file.path().c_str());
+  return PcmResult{
+      .data = std::move(pcm_data),
+      .sample_rate = kTargetSampleRate,
+      .channels = kTargetChannels,
+  };
+}
+
+#if HAS_FFMPEG
+
 // RAII wrappers for FFmpeg resources to guarantee cleanup on exceptions
 struct FormatContextDeleter {
   void operator()(AVFormatContext* ctx) const {
@@ -49,10 +88,8 @@ struct FrameDeleter {
   }
 };
 
-AudioDecoder::AudioDecoder() = default;
-AudioDecoder::~AudioDecoder() = default;
-
-PcmResult AudioDecoder::decode(const std::string& file_path) {
+std::vector<float> AudioDecoder::decode_with_ffmpeg(const std::string& file_path,
+                                                    size_t max_samples) {
   AVFormatContext* raw_format_ctx = nullptr;
   if (avformat_open_input(&raw_format_ctx, file_path.c_str(), nullptr, nullptr) <
       0) {
@@ -115,12 +152,18 @@ PcmResult AudioDecoder::decode(const std::string& file_path) {
   }
 
   std::vector<float> pcm_data;
-  // Pre-allocate based on estimated duration
+  // Pre-allocate based on estimated duration, never beyond the limit
   if (format_ctx->duration > 0 && format_ctx->duration < INT64_MAX / kTargetSampleRate) {
     int64_t estimated_samples =
         (format_ctx->duration * kTargetSampleRate) / AV_TIME_BASE;
-    pcm_data.reserve(static_cast<size_t>(estimated_samples));
+    pcm_data.reserve(std::min(static_cast<size_t>(estimated_samples), max_samples));
   }
+  auto append = [&](const std::vector<float>& buffer, int count) {
+    if (static_cast<size_t>(count) > max_samples - pcm_data.size()) {
+      throw DecodeLimitError("Decoded audio exceeds the sample limit: " + file_path);
+    }
+    pcm_data.insert(pcm_data.end(), buffer.begin(), buffer.begin() + count);
+  };
 
   std::unique_ptr<AVPacket, PacketDeleter> packet(av_packet_alloc());
   std::unique_ptr<AVFrame, FrameDeleter> frame(av_frame_alloc());
@@ -146,10 +189,7 @@ PcmResult AudioDecoder::decode(const std::string& file_path) {
                         const_cast<const uint8_t**>(frame->extended_data),
                         frame->nb_samples);
 
-        if (out_samples > 0) {
-          pcm_data.insert(pcm_data.end(), buffer.begin(),
-                          buffer.begin() + out_samples);
-        }
+        if (out_samples > 0) append(buffer, out_samples);
       }
     }
     av_packet_unref(packet.get());
@@ -161,20 +201,27 @@ PcmResult AudioDecoder::decode(const std::string& file_path) {
     std::vector<float> buffer(flush_samples);
     uint8_t* out_buffers[] = {reinterpret_cast<uint8_t*>(buffer.data())};
     int out_samples = swr_convert(swr_ctx.get(), out_buffers, flush_samples, nullptr, 0);
-    if (out_samples > 0) {
-      pcm_data.insert(pcm_data.end(), buffer.begin(),
-                      buffer.begin() + out_samples);
-    }
+    if (out_samples > 0) append(buffer, out_samples);
   }
 
   LOGI("Decoded %zu samples at %dHz mono from %s", pcm_data.size(),
        kTargetSampleRate, file_path.c_str());
 
-  return PcmResult{
-      .data = std::move(pcm_data),
-      .sample_rate = kTargetSampleRate,
-      .channels = kTargetChannels,
-  };
+  return pcm_data;
 }
 
+#else
+
+std::vector<float> AudioDecoder::decode_with_ffmpeg(const std::string& file_path,
+                                                    size_t /* max_samples */) {
+  // Same message as the FFmpeg build for files that cannot be opened at all.
+  if (access(file_path.c_str(), R_OK) != 0) {
+    throw std::runtime_error("Failed to open audio file: " + file_path);
+  }
+  throw std::runtime_error("Unsupported audio format (built without FFmpeg): " +
+                           file_path);
+}
+
+#endif  // HAS_FFMPEG
+
 }  // namespace deeplayer
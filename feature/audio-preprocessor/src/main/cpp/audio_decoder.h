@@ -1,11 +1,21 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
+#include <stdexcept>
 #include <string>
 #include <vector>
 
 namespace deeplayer {
 
+class PcmFile;
+
+/** Thrown by AudioDecoder::decode when the output would exceed max_samples. */
+class DecodeLimitError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
 struct PcmResult {
   std::vector<float> data;
   int sample_rate;
@@ -15,9 +25,15 @@ struct PcmResult {
 /**
  * Decodes audio files (MP3, FLAC, OGG, WAV, AAC) to 16kHz mono PCM
  * using FFmpeg (libavformat, libavcodec, libswresample).
+ *
+ * Uncompressed WAV and AIFF files skip FFmpeg: they are read and converted
+ * directly by PcmFile.
  */
 class AudioDecoder {
  public:
+  static constexpr int kTargetSampleRate = 16000;
+  static constexpr int kTargetChannels = 1;
+
   AudioDecoder();
   ~AudioDecoder();
 
@@ -27,13 +43,24 @@ class AudioDecoder {
   /**
    * Decode an audio file to 16kHz mono float PCM.
    * @param file_path Path to the audio file.
+   * @param max_samples Largest output accepted. Uncompressed files are checked
+   *     before decoding; other formats stop as soon as they pass the limit.
    * @return PcmResult with 16kHz mono float samples normalized to [-1.0, 1.0].
+   * @throws DecodeLimitError if the output would exceed max_samples.
+   */
+  PcmResult decode(const std::string& file_path,
+                   size_t max_samples = std::numeric_limits<size_t>::max());
+
+  /**
+   * Decode an uncompressed file the caller has already opened, at
+   * kTargetSampleRate, e.g. to size a buffer from its header first.
+   * @throws DecodeLimitError if the output would exceed max_samples.
    */
-  PcmResult decode(const std::string& file_path);
+  PcmResult decode(const PcmFile& file,
+                   size_t max_samples = std::numeric_limits<size_t>::max());
 
  private:
-  static constexpr int kTargetSampleRate = 16000;
-  static constexpr int kTargetChannels = 1;
+  std::vector<float> decode_with_ffmpeg(const std::string& file_path, size_t max_samples);
 };
 
 }  // namespace deeplayer
@@ -2,9 +2,12 @@
 
 #include <climits>
 #include <string>
+#include <vector>
 
 #include "audio_decoder.h"
+#include "batch_decoder.h"
 #include "mel_spectrogram.h"
+#include "pcm_cache.h"
 
 #define LOG_TAG "AudioPreprocessorJNI"
 
@@ -105,4 +108,184 @@ Java_com_deeplayer_feature_audiopreprocessor_NativeAudioPreprocessor_nativeExtra
   }
 }
 
+JNIEXPORT jshortArray JNICALL
+Java_com_deeplayer_feature_audiopreprocessor_NativeAudioPreprocessor_nativeExtractMelSpectrogramF16(
+    JNIEnv* env, jobject /* thiz */, jlong handle, jfloatArray pcmArray) {
+  auto* ctx = reinterpret_cast<NativeContext*>(handle);
+
+  jsize pcm_len = env->GetArrayLength(pcmArray);
+  std::vector<float> pcm(pcm_len);
+  env->GetFloatArrayRegion(pcmArray, 0, pcm_len, pcm.data());
+
+  try {
+    auto mel = ctx->mel.compute_half(pcm);
+    if (mel.size() > static_cast<size_t>(INT_MAX)) {
+      env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                    "Mel spectrogram data too large for JNI array");
+      return nullptr;
+    }
+    jshortArray output = env->NewShortArray(static_cast<jsize>(mel.size()));
+    if (!output) {
+      env->ThrowNew(env->FindClass("java/lang/OutOfMemoryError"),
+                    "Failed to allocate mel spectrogram output array");
+      return nullptr;
+    }
+    env->SetShortArrayRegion(output, 0, static_cast<jsize>(mel.size()),
+                             reinterpret_cast<const jshort*>(mel.data()));
+    return output;
+  } catch (const std::exception& e) {
+    env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+    return nullptr;
+  }
+}
+
+JNIEXPORT jbyteArray JNICALL
+Java_com_deeplayer_feature_audiopreprocessor_NativeAudioPreprocessor_nativeExtractMelSpectrogramU8(
+    JNIEnv* env, jobject /* thiz */, jlong handle, jfloatArray pcmArray,
+    jfloatArray scalesArray, jfloatArray offsetsArray) {
+  auto* ctx = reinterpret_cast<NativeContext*>(handle);
+
+  jsize pcm_len = env->GetArrayLength(pcmArray);
+  std::vector<float> pcm(pcm_len);
+  env->GetFloatArrayRegion(pcmArray, 0, pcm_len, pcm.data());
+
+  // The caller sizes scales/offsets from the frame count it expects.
+  jsize frames = deeplayer::MelSpectrogram::num_frames(pcm.size());
+  if (env->GetArrayLength(scalesArray) < frames ||
+      env->GetArrayLength(offsetsArray) < frames) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  "Scale arrays shorter than the number of mel frames");
+    return nullptr;
+  }
+
+  try {
+    std::vector<float> scales;
+    std::vector<float> offsets;
+    auto mel = ctx->mel.compute_u8(pcm, &scales, &offsets);
+    if (mel.size() > static_cast<size_t>(INT_MAX)) {
+      env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                    "Mel spectrogram data too large for JNI array");
+      return nullptr;
+    }
+    jbyteArray output = env->NewByteArray(static_cast<jsize>(mel.size()));
+    if (!output) {
+      env->ThrowNew(env->FindClass("java/lang/OutOfMemoryError"),
+                    "Failed to allocate mel spectrogram output array");
+      return nullptr;
+    }
+    env->SetByteArrayRegion(output, 0, static_cast<jsize>(mel.size()),
+                            reinterpret_cast<const jbyte*>(mel.data()));
+    env->SetFloatArrayRegion(scalesArray, 0, frames, scales.data());
+    env->SetFloatArrayRegion(offsetsArray, 0, frames, offsets.data());
+    return output;
+  } catch (const std::exception& e) {
+    env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+    return nullptr;
+  }
+}
+
+JNIEXPORT jint JNICALL
+Java_com_deeplayer_feature_audiopreprocessor_NativeAudioPreprocessor_nativeMelFrameCount(
+    JNIEnv* /* env */, jclass /* clazz */, jint numSamples) {
+  if (numSamples < 0) return 0;
+  return deeplayer::MelSpectrogram::num_frames(static_cast<size_t>(numSamples));
+}
+
+JNIEXPORT jint JNICALL
+Java_com_deeplayer_feature_audiopreprocessor_NativeAudioPreprocessor_nativeDecodeBatch(
+    JNIEnv* env, jobject /* thiz */, jobjectArray pathArray, jstring cacheDir,
+    jint numThreads, jlong maxBufferedBytes, jobject callback) {
+  jsize count = env->GetArrayLength(pathArray);
+  std::vector<std::string> paths;
+  paths.reserve(count);
+  for (jsize i = 0; i < count; i++) {
+    auto jpath = static_cast<jstring>(env->GetObjectArrayElement(pathArray, i));
+    const char* path = env->GetStringUTFChars(jpath, nullptr);
+    if (!path) return 0;  // OutOfMemoryError pending
+    paths.emplace_back(path);
+    env->ReleaseStringUTFChars(jpath, path);
+    env->DeleteLocalRef(jpath);
+  }
+
+  deeplayer::BatchOptions options;
+  options.num_threads = numThreads;
+  if (maxBufferedBytes > 0) {
+    options.max_buffered_bytes = static_cast<size_t>(maxBufferedBytes);
+  }
+  if (cacheDir) {
+    const char* dir = env->GetStringUTFChars(cacheDir, nullptr);
+    if (!dir) return 0;
+    options.cache_dir = dir;
+    env->ReleaseStringUTFChars(cacheDir, dir);
+  }
+
+  jclass callback_class = env->GetObjectClass(callback);
+  jmethodID on_decoded = env->GetMethodID(
+      callback_class, "onDecoded", "(I[FLjava/lang/String;Ljava/lang/String;)Z");
+  env->DeleteLocalRef(callback_class);
+  if (!on_decoded) return 0;  // NoSuchMethodError pending
+
+  // Runs on this thread only; workers never touch JNI. Local references are
+  // freed per item since a batch can deliver thousands of them.
+  auto deliver = [&](deeplayer::BatchItem& item) -> bool {
+    jfloatArray pcm = nullptr;
+    jstring key = nullptr;
+    jstring error = nullptr;
+    if (!item.pcm.empty()) {
+      if (item.pcm.size() > static_cast<size_t>(INT_MAX)) {
+        item.error = "PCM data too large for JNI array";
+      } else {
+        pcm = env->NewFloatArray(static_cast<jsize>(item.pcm.size()));
+        if (!pcm) return false;  // OutOfMemoryError pending
+        env->SetFloatArrayRegion(pcm, 0, static_cast<jsize>(item.pcm.size()),
+                                 item.pcm.data());
+      }
+    }
+    if (!item.cache_key.empty()) key = env->NewStringUTF(item.cache_key.c_str());
+    if (!item.error.empty()) error = env->NewStringUTF(item.error.c_str());
+
+    jboolean keep_going = env->CallBooleanMethod(
+        callback, on_decoded, static_cast<jint>(item.index), pcm, key, error);
+    if (pcm) env->DeleteLocalRef(pcm);
+    if (key) env->DeleteLocalRef(key);
+    if (error) env->DeleteLocalRef(error);
+    // A throwing callback cancels the batch; the exception stays pending.
+    return keep_going && !env->ExceptionCheck();
+  };
+
+  try {
+    return static_cast<jint>(deeplayer::decode_batch(paths, options, deliver));
+  } catch (const std::exception& e) {
+    env->ThrowNew(env->FindClass("java/lang/RuntimeException"), e.what());
+    return 0;
+  }
+}
+
+JNIEXPORT jfloatArray JNICALL
+Java_com_deeplayer_feature_audiopreprocessor_NativeAudioPreprocessor_nativeReadCachedPcm(
+    JNIEnv* env, jobject /* thiz */, jstring cacheDir, jstring cacheKey) {
+  const char* dir = env->GetStringUTFChars(cacheDir, nullptr);
+  if (!dir) return nullptr;
+  JniStringGuard dir_guard{env, cacheDir, dir};
+  const char* key = env->GetStringUTFChars(cacheKey, nullptr);
+  if (!key) return nullptr;
+  JniStringGuard key_guard{env, cacheKey, key};
+
+  std::vector<float> pcm;
+  if (!deeplayer::PcmCache(dir).load(key, &pcm)) return nullptr;
+  if (pcm.size() > static_cast<size_t>(INT_MAX)) {
+    env->ThrowNew(env->FindClass("java/lang/IllegalArgumentException"),
+                  "PCM data too large for JNI array");
+    return nullptr;
+  }
+  jfloatArray output = env->NewFloatArray(static_cast<jsize>(pcm.size()));
+  if (!output) {
+    env->ThrowNew(env->FindClass("java/lang/OutOfMemoryError"),
+                  "Failed to allocate PCM output array");
+    return nullptr;
+  }
+  env->SetFloatArrayRegion(output, 0, static_cast<jsize>(pcm.size()), pcm.data());
+  return output;
+}
+
 }  // extern "C"
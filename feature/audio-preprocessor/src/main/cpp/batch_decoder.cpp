@@ -0,0 +1,303 @@
+#include "batch_decoder.h"
+
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <stdexcept>
+#include <thread>
+
+#include "audio_decoder.h"
+#include "memory_budget.h"
+#include "pcm_cache.h"
+#include "pcm_file_decoder.h"
+
+namespace deeplayer {
+
+namespace {
+
+/**
+ * PCM bytes reserved per input byte for compressed files, whose decoded size
+ * is unknown until they are decoded. 16kHz mono float is 64 KB/s, four times
+ * a 128 kbps stream; lossless and higher-bitrate files need less. Files that
+ * need more are stopped at the reservation and decoded again alone.
+ */
+constexpr size_t kPcmBytesPerInputByte = 4;
+
+size_t saturating_mul(size_t a, size_t b) {
+  return b != 0 && a > std::numeric_limits<size_t>::max() / b
+             ? std::numeric_limits<size_t>::max()
+             : a * b;
+}
+
+/**
+ * One deque of file indices per worker. Owners take from the front, thieves
+ * from the back. No work is added once the batch starts, so a worker that
+ * finds every queue empty is done.
+ */
+class WorkQueues {
+ public:
+  explicit WorkQueues(size_t num_workers) : queues_(num_workers) {}
+
+  void push(size_t worker, size_t item) { queues_[worker].items.push_back(item); }
+
+  bool pop(size_t worker, size_t* item) {
+    {
+      Queue& own = queues_[worker];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (!own.items.empty()) {
+        *item = own.items.front();
+        own.items.pop_front();
+        return true;
+      }
+    }
+    for (size_t i = 1; i < queues_.size(); i++) {
+      Queue& victim = queues_[(worker + i) % queues_.size()];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (!victim.items.empty()) {
+        *item = victim.items.back();
+        victim.items.pop_back();
+        return true;
+      }
+    }
+    return false;
+  }
+
+ private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<size_t> items;
+  };
+  std::vector<Queue> queues_;
+};
+
+struct Completed {
+  BatchItem item;
+  /** Budget bytes held by item.pcm, released once it is delivered. */
+  size_t bytes;
+};
+
+class Batch {
+ public:
+  Batch(const std::vector<std::string>& paths, const BatchOptions& options,
+        size_t num_workers)
+      : paths_(paths),
+        budget_(options.max_buffered_bytes),
+        queues_(num_workers),
+        num_workers_(num_workers) {
+    if (!options.cache_dir.empty()) {
+      cache_ = std::make_unique<PcmCache>(options.cache_dir);
+    }
+
+    // Deal files largest first so long tracks start early and the short
+    // ones fill the gaps at the end.
+    sizes_.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); i++) {
+      struct stat st;
+      // Saturate rather than truncate sizes beyond size_t (32-bit ABIs);
+      // decoding such a file fails on its own.
+      sizes_[i] = stat(paths[i].c_str(), &st) == 0
+                      ? static_cast<size_t>(std::min<uint64_t>(
+                            st.st_size, std::numeric_limits<size_t>::max()))
+                      : 0;
+    }
+    std::vector<size_t> order(paths.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return sizes_[a] > sizes_[b]; });
+    for (size_t i = 0; i < order.size(); i++) {
+      queues_.push(i % num_workers, order[i]);
+    }
+  }
+
+  size_t run(const BatchCallback& callback) {
+    std::vector<std::thread> workers;
+    workers.reserve(num_workers_);
+    for (size_t w = 0; w < num_workers_; w++) {
+      workers.emplace_back([this, w] { work(w); });
+    }
+
+    size_t delivered = 0;
+    std::exception_ptr callback_error;
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+      cv_.wait(lock, [&] { return !completed_.empty() || finished_ == num_workers_; });
+      if (completed_.empty()) break;
+      Completed done = std::move(completed_.front());
+      completed_.pop_front();
+      lock.unlock();
+
+      // After cancellation, remaining results are dropped undelivered.
+      if (!cancelled_) {
+        bool keep_going = false;
+        try {
+          keep_going = callback(done.item);
+          delivered++;
+        } catch (...) {
+          callback_error = std::current_exception();
+        }
+        if (!keep_going) cancel();
+      }
+      done.item.pcm = std::vector<float>();
+      budget_.release(done.bytes);
+
+      lock.lock();
+    }
+    lock.unlock();
+
+    for (auto& worker : workers) worker.join();
+    if (callback_error) std::rethrow_exception(callback_error);
+    return delivered;
+  }
+
+ private:
+  const std::vector<std::string>& paths_;
+  std::vector<size_t> sizes_;
+  std::unique_ptr<PcmCache> cache_;
+  MemoryBudget budget_;
+  WorkQueues queues_;
+  const size_t num_workers_;
+  std::atomic<bool> cancelled_{false};
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Completed> completed_;
+  size_t finished_ = 0;
+
+  void cancel() {
+    cancelled_ = true;
+    budget_.cancel();
+  }
+
+  void work(size_t worker) {
+    AudioDecoder decoder;
+    size_t index;
+    while (!cancelled_ && queues_.pop(worker, &index)) {
+      Completed done{};
+      done.item.index = index;
+      if (!decode_one(decoder, &done)) break;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        completed_.push_back(std::move(done));
+      }
+      cv_.notify_one();
+    }
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_++;
+    }
+    cv_.notify_one();
+  }
+
+  /**
+   * Look the file up in the cache: by stamp first, hashing its contents only
+   * when the stamp is new.
+   * @return whether decoding can be skipped.
+   */
+  bool find_cached(const std::string& path, const std::string& stamp, BatchItem* item) {
+    if (stamp.empty()) throw std::runtime_error("Failed to open audio file: " + path);
+    item->cache_key = cache_->lookup(stamp);
+    if (!item->cache_key.empty() && cache_->contains(item->cache_key)) return true;
+
+    item->cache_key = PcmCache::content_key(path);
+    if (item->cache_key.empty()) {
+      throw std::runtime_error("Failed to open audio file: " + path);
+    }
+    // A copy of a file already decoded under another path.
+    if (!cache_->contains(item->cache_key)) return false;
+    cache_->remember(stamp, item->cache_key);
+    return true;
+  }
+
+  /**
+   * Decode within a reservation of bytes. If the output outgrows it, the
+   * partial result is dropped and the file is decoded again holding the
+   * whole budget.
+   * @return false if cancelled while waiting for memory.
+   */
+  bool decode_within_budget(AudioDecoder& decoder, const std::string& path,
+                            BatchItem* item, size_t* reserved) {
+    // An uncompressed file is opened once: its header gives the exact output
+    // size to reserve, and the same descriptor is decoded.
+    PcmFile pcm_file;
+    bool is_pcm = pcm_file.open(path, AudioDecoder::kTargetSampleRate);
+    auto decode = [&](size_t max_samples) {
+      return is_pcm ? decoder.decode(pcm_file, max_samples).data
+                    : decoder.decode(path, max_samples).data;
+    };
+    size_t bytes = is_pcm ? saturating_mul(pcm_file.output_size(), sizeof(float))
+                          : saturating_mul(sizes_[item->index], kPcmBytesPerInputByte);
+    if (bytes < budget_.limit()) {
+      if (!budget_.acquire(bytes)) return false;
+      *reserved = bytes;
+      try {
+        item->pcm = decode(bytes / sizeof(float));
+        return true;
+      } catch (const DecodeLimitError&) {
+        budget_.release(*reserved);
+        *reserved = 0;
+      }
+    }
+    if (!budget_.acquire(budget_.limit())) return false;
+    *reserved = budget_.limit();
+    item->pcm = decode(std::numeric_limits<size_t>::max());
+    return true;
+  }
+
+  /** @return false if cancelled while waiting for memory. */
+  bool decode_one(AudioDecoder& decoder, Completed* done) {
+    BatchItem& item = done->item;
+    const std::string& path = paths_[item.index];
+    size_t reserved = 0;
+    try {
+      std::string stamp;
+      if (cache_) {
+        stamp = PcmCache::file_stamp(path);
+        item.cache_hit = find_cached(path, stamp, &item);
+        if (item.cache_hit) return true;
+      }
+
+      if (!decode_within_budget(decoder, path, &item, &reserved)) return false;
+      size_t actual = item.pcm.size() * sizeof(float);
+      budget_.adjust(reserved, actual);
+      reserved = actual;
+
+      if (cache_) {
+        cache_->store(item.cache_key, item.pcm, AudioDecoder::kTargetSampleRate);
+        cache_->remember(stamp, item.cache_key);
+        item.pcm = std::vector<float>();
+        budget_.release(reserved);
+        reserved = 0;
+      }
+    } catch (const std::exception& e) {
+      item.error = e.what();
+      item.pcm = std::vector<float>();
+      budget_.release(reserved);
+      reserved = 0;
+    }
+    done->bytes = reserved;
+    return true;
+  }
+};
+
+}  // namespace
+
+size_t decode_batch(const std::vector<std::string>& paths,
+                    const BatchOptions& options, const BatchCallback& callback) {
+  if (paths.empty()) return 0;
+  size_t num_workers = options.num_threads > 0
+                           ? static_cast<size_t>(options.num_threads)
+                           : std::max(1u, std::thread::hardware_concurrency());
+  num_workers = std::min(num_workers, paths.size());
+  Batch batch(paths, options, num_workers);
+  return batch.run(callback);
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace deeplayer {
+
+/** Outcome of decoding one file of a batch. */
+struct BatchItem {
+  /** Position of the file in the input list. */
+  size_t index;
+  /** 16kHz mono samples; empty in cache mode or on error. */
+  std::vector<float> pcm;
+  /** Key of the PcmCache entry holding the samples (cache mode only). */
+  std::string cache_key;
+  /** Whether the entry already existed and decoding was skipped. */
+  bool cache_hit = false;
+  /** Failure message; empty on success. */
+  std::string error;
+};
+
+struct BatchOptions {
+  /** Worker threads; 0 for one per online core. */
+  int num_threads = 0;
+  /**
+   * Decoded PCM allowed in memory at once, counting files being decoded and
+   * results not yet handed to the callback. Workers reserve room before
+   * starting a file and wait for it, so a slow consumer throttles decoding.
+   * Uncompressed files reserve their exact size; compressed files reserve an
+   * estimate and are decoded again alone if they outgrow it. A single file
+   * larger than the cap is still decoded, alone.
+   */
+  size_t max_buffered_bytes = 256u << 20;
+  /**
+   * If non-empty, results are written to a PcmCache in this directory and
+   * only their keys are delivered. Files already in the cache are not
+   * decoded again, and unchanged ones are not even read.
+   */
+  std::string cache_dir;
+};
+
+/**
+ * Receives each finished file on the thread that called decode_batch, in
+ * completion order. Return false to cancel the files not yet delivered.
+ */
+using BatchCallback = std::function<bool(BatchItem& item)>;
+
+/**
+ * Decode many files to 16kHz mono PCM on a pool of worker threads.
+ *
+ * Files are dealt to per-worker queues largest first; a worker that runs out
+ * steals from the tail of another's queue, so a few long files do not leave
+ * the other cores idle. Per-file failures are reported through the callback
+ * and do not stop the batch.
+ *
+ * Blocks until every file has been delivered or the batch is cancelled.
+ * @return Number of items passed to the callback.
+ */
+size_t decode_batch(const std::vector<std::string>& paths,
+                    const BatchOptions& options, const BatchCallback& callback);
+
+}  // namespace deeplayer
@@ -0,0 +1,214 @@
+#include "feature_codec.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#if defined(__F16C__)
+#include <immintrin.h>
+#endif
+#endif
+
+namespace deeplayer {
+
+namespace {
+
+inline uint32_t round_shift(uint32_t value, int shift) {
+  uint32_t result = value >> shift;
+  uint32_t remainder = value & ((1u << shift) - 1);
+  uint32_t half = 1u << (shift - 1);
+  if (remainder > half || (remainder == half && (result & 1))) result++;
+  return result;
+}
+
+uint16_t float_to_half_scalar(float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  uint32_t sign = (bits >> 16) & 0x8000;
+  int exp = static_cast<int>((bits >> 23) & 0xFF);
+  uint32_t mantissa = bits & 0x7FFFFF;
+  if (exp == 0xFF) {
+    // Inf stays Inf; NaN stays a quiet NaN.
+    return static_cast<uint16_t>(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+  }
+  int half_exp = exp - 127 + 15;
+  if (half_exp >= 0x1F) return static_cast<uint16_t>(sign | 0x7C00);
+  if (half_exp <= 0) {
+    // Subnormal half: shift the full significand into units of 2^-24.
+    if (half_exp < -10) return static_cast<uint16_t>(sign);
+    return static_cast<uint16_t>(sign | round_shift(mantissa | 0x800000, 14 - half_exp));
+  }
+  // A carry out of the mantissa correctly bumps the exponent, up to Inf.
+  return static_cast<uint16_t>(sign | ((static_cast<uint32_t>(half_exp) << 10) +
+                                       round_shift(mantissa, 13)));
+}
+
+float half_to_float_scalar(uint16_t half) {
+  uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16;
+  uint32_t exp = (half >> 10) & 0x1F;
+  uint32_t mantissa = half & 0x3FF;
+  uint32_t bits;
+  if (exp == 0x1F) {
+    bits = sign | 0x7F800000 | mantissa << 13;
+  } else if (exp != 0) {
+    bits = sign | (exp + 112) << 23 | mantissa << 13;
+  } else {
+    // Zero or subnormal: mantissa units of 2^-24.
+    float value = static_cast<float>(mantissa) * 5.9604645e-8f;
+    return sign ? -value : value;
+  }
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+void row_range(const float* src, size_t n, float* lo, float* hi) {
+  size_t i = 0;
+  float min_v = src[0];
+  float max_v = src[0];
+#if defined(__ARM_NEON)
+  if (n >= 4) {
+    float32x4_t vmin = vld1q_f32(src);
+    float32x4_t vmax = vmin;
+    for (i = 4; i + 4 <= n; i += 4) {
+      float32x4_t v = vld1q_f32(src + i);
+      vmin = vminq_f32(vmin, v);
+      vmax = vmaxq_f32(vmax, v);
+    }
+#if defined(__aarch64__)
+    min_v = vminvq_f32(vmin);
+    max_v = vmaxvq_f32(vmax);
+#else
+    float32x2_t pmin = vpmin_f32(vget_low_f32(vmin), vget_high_f32(vmin));
+    float32x2_t pmax = vpmax_f32(vget_low_f32(vmax), vget_high_f32(vmax));
+    min_v = vget_lane_f32(vpmin_f32(pmin, pmin), 0);
+    max_v = vget_lane_f32(vpmax_f32(pmax, pmax), 0);
+#endif
+  }
+#elif defined(__SSE2__)
+  if (n >= 4) {
+    __m128 vmin = _mm_loadu_ps(src);
+    __m128 vmax = vmin;
+    for (i = 4; i + 4 <= n; i += 4) {
+      __m128 v = _mm_loadu_ps(src + i);
+      vmin = _mm_min_ps(vmin, v);
+      vmax = _mm_max_ps(vmax, v);
+    }
+    vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(1, 0, 3, 2)));
+    vmin = _mm_min_ps(vmin, _mm_shuffle_ps(vmin, vmin, _MM_SHUFFLE(2, 3, 0, 1)));
+    vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(1, 0, 3, 2)));
+    vmax = _mm_max_ps(vmax, _mm_shuffle_ps(vmax, vmax, _MM_SHUFFLE(2, 3, 0, 1)));
+    min_v = _mm_cvtss_f32(vmin);
+    max_v = _mm_cvtss_f32(vmax);
+  }
+#endif
+  for (; i < n; i++) {
+    min_v = std::min(min_v, src[i]);
+    max_v = std::max(max_v, src[i]);
+  }
+  *lo = min_v;
+  *hi = max_v;
+}
+
+}  // namespace
+
+void float_to_half(const float* src, size_t n, uint16_t* dst) {
+  size_t i = 0;
+#if defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    float16x4_t h = vcvt_f16_f32(vld1q_f32(src + i));
+    vst1_u16(dst + i, vreinterpret_u16_f16(h));
+  }
+#elif defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), h);
+  }
+#endif
+  for (; i < n; i++) dst[i] = float_to_half_scalar(src[i]);
+}
+
+void half_to_float(const uint16_t* src, size_t n, float* dst) {
+  size_t i = 0;
+#if defined(__aarch64__)
+  for (; i + 4 <= n; i += 4) {
+    vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+  }
+#elif defined(__F16C__)
+  for (; i + 8 <= n; i += 8) {
+    __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+    _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+  }
+#endif
+  for (; i < n; i++) dst[i] = half_to_float_scalar(src[i]);
+}
+
+void quantize_row_u8(const float* src, size_t n, uint8_t* dst, float* scale,
+                     float* offset) {
+  if (n == 0) {
+    *scale = 0.0f;
+    *offset = 0.0f;
+    return;
+  }
+  float lo, hi;
+  row_range(src, n, &lo, &hi);
+  if (!std::isfinite(hi)) {
+    *scale = 0.0f;
+    *offset = hi;
+    std::memset(dst, 0, n);
+    return;
+  }
+  lo = std::max(lo, hi - kMaxInt8Range);
+  *offset = lo;
+  if (hi == lo) {
+    *scale = 0.0f;
+    std::memset(dst, 0, n);
+    return;
+  }
+  *scale = (hi - lo) / 255.0f;
+  const float inv = 255.0f / (hi - lo);
+
+  // Clamping before the +0.5 keeps the rounding identical to the Kotlin
+  // encoder (and stops the compiler from fusing it into an FMA).
+  size_t i = 0;
+#if defined(__ARM_NEON)
+  const float32x4_t vlo = vdupq_n_f32(lo);
+  const float32x4_t vinv = vdupq_n_f32(inv);
+  const float32x4_t vzero = vdupq_n_f32(0.0f);
+  const float32x4_t vmax = vdupq_n_f32(255.0f);
+  const float32x4_t vhalf = vdupq_n_f32(0.5f);
+  for (; i + 8 <= n; i += 8) {
+    float32x4_t a = vmulq_f32(vsubq_f32(vld1q_f32(src + i), vlo), vinv);
+    float32x4_t b = vmulq_f32(vsubq_f32(vld1q_f32(src + i + 4), vlo), vinv);
+    a = vaddq_f32(vminq_f32(vmaxq_f32(a, vzero), vmax), vhalf);
+    b = vaddq_f32(vminq_f32(vmaxq_f32(b, vzero), vmax), vhalf);
+    uint16x8_t codes = vcombine_u16(vmovn_u32(vcvtq_u32_f32(a)),
+                                    vmovn_u32(vcvtq_u32_f32(b)));
+    vst1_u8(dst + i, vmovn_u16(codes));
+  }
+#elif defined(__SSE2__)
+  const __m128 vlo = _mm_set1_ps(lo);
+  const __m128 vinv = _mm_set1_ps(inv);
+  const __m128 vzero = _mm_setzero_ps();
+  const __m128 vmax = _mm_set1_ps(255.0f);
+  const __m128 vhalf = _mm_set1_ps(0.5f);
+  for (; i + 8 <= n; i += 8) {
+    __m128 a = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i), vlo), vinv);
+    __m128 b = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src + i + 4), vlo), vinv);
+    a = _mm_add_ps(_mm_min_ps(_mm_max_ps(a, vzero), vmax), vhalf);
+    b = _mm_add_ps(_mm_min_ps(_mm_max_ps(b, vzero), vmax), vhalf);
+    __m128i codes = _mm_packs_epi32(_mm_cvttps_epi32(a), _mm_cvttps_epi32(b));
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(dst + i), _mm_packus_epi16(codes, codes));
+  }
+#endif
+  for (; i < n; i++) {
+    float code = std::min(std::max((src[i] - lo) * inv, 0.0f), 255.0f) + 0.5f;
+    dst[i] = static_cast<uint8_t>(code);
+  }
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace deeplayer {
+
+/**
+ * Compact encodings for per-frame feature matrices (log-mel bands, phoneme
+ * log-probabilities). They match FrameMatrix.Float16 / FrameMatrix.Int8 in
+ * core/contracts, so encoded rows can be handed to Kotlin as-is.
+ */
+
+/**
+ * Widest span of one 8-bit encoded row. Values further below the row maximum
+ * clamp to the bottom code. Must match FrameMatrix.MAX_INT8_RANGE.
+ */
+constexpr float kMaxInt8Range = 64.0f;
+
+/**
+ * Convert floats to IEEE binary16 bit patterns, rounding to nearest even.
+ * Uses the hardware conversion on AArch64 and on x86 built with F16C; other
+ * targets use an equivalent scalar routine.
+ */
+void float_to_half(const float* src, size_t n, uint16_t* dst);
+
+/** Convert IEEE binary16 bit patterns back to floats (exact). */
+void half_to_float(const uint16_t* src, size_t n, float* dst);
+
+/**
+ * Quantize one row to 8-bit codes: dst[i] = round((src[i] - offset) / scale).
+ * offset is max(row min, row max - kMaxInt8Range) and scale spreads the row
+ * over 255 steps. A constant row gets scale 0; a row whose maximum is not
+ * finite gets scale 0 and offset equal to that maximum.
+ */
+void quantize_row_u8(const float* src, size_t n, uint8_t* dst, float* scale,
+                     float* offset);
+
+}  // namespace deeplayer
@@ -0,0 +1,40 @@
+#include "mapped_file.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <limits>
+
+namespace deeplayer {
+
+MappedFile::MappedFile() = default;
+
+MappedFile::~MappedFile() {
+  if (data_) munmap(data_, size_);
+}
+
+bool MappedFile::open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat st;
+  // On 32-bit ABIs st_size is 64-bit: a file beyond the address space cannot
+  // be mapped, and its size must not be truncated into size_t.
+  if (fstat(fd, &st) != 0 || st.st_size <= 0 ||
+      static_cast<uint64_t>(st.st_size) > std::numeric_limits<size_t>::max()) {
+    close(fd);
+    return false;
+  }
+  void* addr =
+      mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file.
+  close(fd);
+  if (addr == MAP_FAILED) return false;
+  data_ = addr;
+  size_ = static_cast<size_t>(st.st_size);
+  madvise(data_, size_, MADV_SEQUENTIAL);
+  return true;
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace deeplayer {
+
+/**
+ * Read-only private mapping of a whole file.
+ *
+ * Only for files that are replaced by rename, like cache entries, never
+ * rewritten in place: reading a mapping past the end of a file truncated
+ * after open() raises SIGBUS.
+ */
+class MappedFile {
+ public:
+  MappedFile();
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  /**
+   * Map the file at path for sequential reading.
+   * @return false if the file cannot be opened, is empty, is larger than the
+   *     address space (possible on 32-bit ABIs) or cannot be mapped.
+   */
+  bool open(const std::string& path);
+
+  const uint8_t* data() const { return static_cast<const uint8_t*>(data_); }
+  size_t size() const { return size_; }
+
+ private:
+  void* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace deeplayer
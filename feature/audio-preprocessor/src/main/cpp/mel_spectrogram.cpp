@@ -4,9 +4,12 @@
 #include <cmath>
 #include <stdexcept>
 
+#include "feature_codec.h"
+
 namespace deeplayer {
 
-MelSpectrogram::MelSpectrogram() {
+MelSpectrogram::MelSpectrogram()
+    : fft_real_(kFftSize), fft_imag_(kFftSize), power_spectrum_(kNumFftBins) {
   init_hann_window();
   init_mel_filterbank();
 }
@@ -117,50 +120,73 @@ void MelSpectrogram::fft(std::vector<float>& real, std::vector<float>& imag) {
   }
 }
 
-std::vector<float> MelSpectrogram::compute(const std::vector<float>& pcm) {
-  if (pcm.size() < static_cast<size_t>(kWindowSize)) {
-    return {};
-  }
-
-  int num_frames =
-      (static_cast<int>(pcm.size()) - kWindowSize) / kHopSize + 1;
-  std::vector<float> mel_output(num_frames * kNumMelBands);
-
-  std::vector<float> fft_real(kFftSize);
-  std::vector<float> fft_imag(kFftSize);
-  std::vector<float> power_spectrum(kNumFftBins);
+int MelSpectrogram::num_frames(size_t num_samples) {
+  if (num_samples < static_cast<size_t>(kWindowSize)) return 0;
+  return (static_cast<int>(num_samples) - kWindowSize) / kHopSize + 1;
+}
 
-  for (int frame = 0; frame < num_frames; frame++) {
-    int start = frame * kHopSize;
+void MelSpectrogram::compute_frame(const float* samples, float* out) {
+  // Apply Hann window and zero-pad to FFT size
+  std::fill(fft_real_.begin(), fft_real_.end(), 0.0f);
+  std::fill(fft_imag_.begin(), fft_imag_.end(), 0.0f);
+  for (int i = 0; i < kWindowSize; i++) {
+    fft_real_[i] = samples[i] * hann_window_[i];
+  }
 
-    // Apply Hann window and zero-pad to FFT size
-    std::fill(fft_real.begin(), fft_real.end(), 0.0f);
-    std::fill(fft_imag.begin(), fft_imag.end(), 0.0f);
-    for (int i = 0; i < kWindowSize; i++) {
-      fft_real[i] = pcm[start + i] * hann_window_[i];
-    }
+  // FFT
+  fft(fft_real_, fft_imag_);
 
-    // FFT
-    fft(fft_real, fft_imag);
+  // Power spectrum
+  for (int k = 0; k < kNumFftBins; k++) {
+    power_spectrum_[k] =
+        fft_real_[k] * fft_real_[k] + fft_imag_[k] * fft_imag_[k];
+  }
 
-    // Power spectrum
+  // Apply mel filterbank and log
+  for (int m = 0; m < kNumMelBands; m++) {
+    float energy = 0.0f;
     for (int k = 0; k < kNumFftBins; k++) {
-      power_spectrum[k] =
-          fft_real[k] * fft_real[k] + fft_imag[k] * fft_imag[k];
+      energy += mel_filterbank_[m][k] * power_spectrum_[k];
     }
+    // Log-mel with floor to avoid log(0)
+    out[m] = std::log(std::max(energy, 1e-10f));
+  }
+}
 
-    // Apply mel filterbank and log
-    for (int m = 0; m < kNumMelBands; m++) {
-      float energy = 0.0f;
-      for (int k = 0; k < kNumFftBins; k++) {
-        energy += mel_filterbank_[m][k] * power_spectrum[k];
-      }
-      // Log-mel with floor to avoid log(0)
-      mel_output[frame * kNumMelBands + m] =
-          std::log(std::max(energy, 1e-10f));
-    }
+std::vector<float> MelSpectrogram::compute(const std::vector<float>& pcm) {
+  int frames = num_frames(pcm.size());
+  std::vector<float> mel_output(static_cast<size_t>(frames) * kNumMelBands);
+  for (int frame = 0; frame < frames; frame++) {
+    compute_frame(pcm.data() + frame * kHopSize,
+                  mel_output.data() + frame * kNumMelBands);
   }
+  return mel_output;
+}
 
+std::vector<uint16_t> MelSpectrogram::compute_half(const std::vector<float>& pcm) {
+  int frames = num_frames(pcm.size());
+  std::vector<uint16_t> mel_output(static_cast<size_t>(frames) * kNumMelBands);
+  float row[kNumMelBands];
+  for (int frame = 0; frame < frames; frame++) {
+    compute_frame(pcm.data() + frame * kHopSize, row);
+    float_to_half(row, kNumMelBands, mel_output.data() + frame * kNumMelBands);
+  }
+  return mel_output;
+}
+
+std::vector<uint8_t> MelSpectrogram::compute_u8(const std::vector<float>& pcm,
+                                                std::vector<float>* scales,
+                                                std::vector<float>* offsets) {
+  int frames = num_frames(pcm.size());
+  std::vector<uint8_t> mel_output(static_cast<size_t>(frames) * kNumMelBands);
+  scales->resize(frames);
+  offsets->resize(frames);
+  float row[kNumMelBands];
+  for (int frame = 0; frame < frames; frame++) {
+    compute_frame(pcm.data() + frame * kHopSize, row);
+    quantize_row_u8(row, kNumMelBands, mel_output.data() + frame * kNumMelBands,
+                    &(*scales)[frame], &(*offsets)[frame]);
+  }
   return mel_output;
 }
 
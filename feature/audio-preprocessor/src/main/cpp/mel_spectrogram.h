@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -31,6 +32,25 @@ class MelSpectrogram {
    */
   std::vector<float> compute(const std::vector<float>& pcm);
 
+  /**
+   * Same as compute(), stored as IEEE half floats (see float_to_half). Each
+   * frame is converted as it is produced, so no float matrix is held.
+   */
+  std::vector<uint16_t> compute_half(const std::vector<float>& pcm);
+
+  /**
+   * Same as compute(), stored as 8-bit codes with a per-frame scale and
+   * offset (see quantize_row_u8).
+   * @param scales Receives one scale per frame.
+   * @param offsets Receives one offset per frame.
+   */
+  std::vector<uint8_t> compute_u8(const std::vector<float>& pcm,
+                                  std::vector<float>* scales,
+                                  std::vector<float>* offsets);
+
+  /** Number of frames produced for num_samples input samples. */
+  static int num_frames(size_t num_samples);
+
   /** Number of mel bands. */
   static constexpr int kNumMelBands = 80;
   /** FFT window size in samples. */
@@ -53,6 +73,10 @@ class MelSpectrogram {
   std::vector<float> hann_window_;
   std::vector<std::vector<float>> mel_filterbank_;
 
+  std::vector<float> fft_real_;
+  std::vector<float> fft_imag_;
+  std::vector<float> power_spectrum_;
+
   void init_hann_window();
   void init_mel_filterbank();
 
@@ -61,6 +85,9 @@ class MelSpectrogram {
 
   /** In-place real FFT using radix-2 Cooley-Tukey. */
   void fft(std::vector<float>& real, std::vector<float>& imag);
+
+  /** Log-mel energies of the window starting at samples into out[0..80). */
+  void compute_frame(const float* samples, float* out);
 };
 
 }  // namespace deeplayer
@@ -0,0 +1,43 @@
+#include "memory_budget.h"
+
+namespace deeplayer {
+
+MemoryBudget::MemoryBudget(size_t limit) : limit_(limit) {}
+
+bool MemoryBudget::acquire(size_t bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  if (bytes >= limit_) {
+    exclusive_waiting_++;
+    cv_.wait(lock, [&] { return cancelled_ || used_ == 0; });
+    exclusive_waiting_--;
+  } else {
+    // Written as a subtraction: used_ + bytes may not fit in size_t.
+    cv_.wait(lock, [&] {
+      return cancelled_ ||
+             (exclusive_waiting_ == 0 && used_ <= limit_ && bytes <= limit_ - used_);
+    });
+  }
+  if (cancelled_) return false;
+  used_ += bytes;
+  return true;
+}
+
+void MemoryBudget::adjust(size_t reserved, size_t actual) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  used_ = used_ - reserved + actual;
+  if (actual < reserved) cv_.notify_all();
+}
+
+void MemoryBudget::release(size_t bytes) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  used_ -= bytes;
+  cv_.notify_all();
+}
+
+void MemoryBudget::cancel() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  cancelled_ = true;
+  cv_.notify_all();
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+namespace deeplayer {
+
+/**
+ * Counting budget of buffered bytes shared by the workers of a batch.
+ *
+ * Holders never grow past their reservation except when running alone, so
+ * the total stays under the limit apart from a single oversized holder.
+ */
+class MemoryBudget {
+ public:
+  explicit MemoryBudget(size_t limit);
+
+  size_t limit() const { return limit_; }
+
+  /**
+   * Wait until bytes fit under the limit. A request of the whole limit or more
+   * waits until nothing else is held and then runs alone; while it waits, new
+   * smaller requests queue behind it so it cannot be starved.
+   * @return false if the budget was cancelled while waiting.
+   */
+  bool acquire(size_t bytes);
+
+  /**
+   * Replace a reservation with the actual size. Growth is only allowed for a
+   * holder running alone; everyone else must stay within what they acquired.
+   */
+  void adjust(size_t reserved, size_t actual);
+
+  void release(size_t bytes);
+
+  /** Fail every pending and future acquire. */
+  void cancel();
+
+ private:
+  const size_t limit_;
+  size_t used_ = 0;
+  /** Whole-limit requests waiting for the budget to drain. */
+  int exclusive_waiting_ = 0;
+  bool cancelled_ = false;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+};
+
+}  // namespace deeplayer
@@ -0,0 +1,281 @@
+#include "pcm_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+#include "mapped_file.h"
+
+namespace deeplayer {
+
+namespace {
+
+constexpr char kMagic[4] = {'D', 'P', 'C', 'M'};
+constexpr uint32_t kFormatVersion = 1;
+
+struct EntryHeader {
+  char magic[4];
+  uint32_t version;
+  uint32_t sample_rate;
+  uint32_t reserved;
+  uint64_t num_samples;
+};
+
+struct FileCloser {
+  void operator()(FILE* f) const {
+    if (f) fclose(f);
+  }
+};
+
+// xxHash64 (https://github.com/Cyan4973/xxHash), seed 0. Processes 32 bytes
+// per step in four independent lanes, so hashing runs near memory bandwidth.
+constexpr uint64_t kPrime1 = 11400714785074694791ULL;
+constexpr uint64_t kPrime2 = 14029467366897019727ULL;
+constexpr uint64_t kPrime3 = 1609587929392839161ULL;
+constexpr uint64_t kPrime4 = 9650029242287828579ULL;
+constexpr uint64_t kPrime5 = 2870177450012600261ULL;
+
+inline uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t read64(const uint8_t* p) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint32_t read32(const uint8_t* p) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+inline uint64_t xxh_round(uint64_t acc, uint64_t input) {
+  acc += input * kPrime2;
+  acc = rotl(acc, 31);
+  return acc * kPrime1;
+}
+
+inline uint64_t xxh_merge(uint64_t acc, uint64_t val) {
+  acc ^= xxh_round(0, val);
+  return acc * kPrime1 + kPrime4;
+}
+
+/** xxHash64 of data fed in pieces of any size. */
+class Xxh64 {
+ public:
+  void update(const uint8_t* p, size_t len) {
+    total_ += len;
+    if (buffered_ + len < kStripe) {
+      std::memcpy(buffer_ + buffered_, p, len);
+      buffered_ += len;
+      return;
+    }
+    if (buffered_ > 0) {
+      size_t fill = kStripe - buffered_;
+      std::memcpy(buffer_ + buffered_, p, fill);
+      consume(buffer_);
+      p += fill;
+      len -= fill;
+      buffered_ = 0;
+    }
+    for (; len >= kStripe; p += kStripe, len -= kStripe) consume(p);
+    std::memcpy(buffer_, p, len);
+    buffered_ = len;
+  }
+
+  uint64_t digest() const {
+    uint64_t h;
+    if (total_ >= kStripe) {
+      h = rotl(v_[0], 1) + rotl(v_[1], 7) + rotl(v_[2], 12) + rotl(v_[3], 18);
+      for (uint64_t v : v_) h = xxh_merge(h, v);
+    } else {
+      h = kPrime5;
+    }
+    h += total_;
+
+    const uint8_t* p = buffer_;
+    const uint8_t* end = buffer_ + buffered_;
+    for (; p + 8 <= end; p += 8) {
+      h ^= xxh_round(0, read64(p));
+      h = rotl(h, 27) * kPrime1 + kPrime4;
+    }
+    if (p + 4 <= end) {
+      h ^= static_cast<uint64_t>(read32(p)) * kPrime1;
+      h = rotl(h, 23) * kPrime2 + kPrime3;
+      p += 4;
+    }
+    for (; p < end; p++) {
+      h ^= *p * kPrime5;
+      h = rotl(h, 11) * kPrime1;
+    }
+
+    h ^= h >> 33;
+    h *= kPrime2;
+    h ^= h >> 29;
+    h *= kPrime3;
+    h ^= h >> 32;
+    return h;
+  }
+
+ private:
+  static constexpr size_t kStripe = 32;
+
+  void consume(const uint8_t* p) {
+    for (int lane = 0; lane < 4; lane++) v_[lane] = xxh_round(v_[lane], read64(p + 8 * lane));
+  }
+
+  uint64_t v_[4] = {kPrime1 + kPrime2, kPrime2, 0, 0 - kPrime1};
+  uint8_t buffer_[kStripe];
+  size_t buffered_ = 0;
+  uint64_t total_ = 0;
+};
+
+uint64_t xxh64(const uint8_t* p, size_t len) {
+  Xxh64 hash;
+  hash.update(p, len);
+  return hash.digest();
+}
+
+/** Bytes read per call while hashing a source file. */
+constexpr size_t kHashChunk = 1 << 20;
+
+/** Length of a content key: 16 hex digits. */
+constexpr size_t kKeyLength = 16;
+
+/** Unique per thread so two workers writing the same file never share one. */
+std::string temp_path_for(const std::string& path) {
+  return path + ".tmp" +
+         std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+}  // namespace
+
+PcmCache::PcmCache(std::string dir) : dir_(std::move(dir)) {}
+
+std::string PcmCache::content_key(const std::string& file_path) {
+  // Read rather than mapped: the file belongs to the user's library and may
+  // be truncated while it is hashed, which would raise SIGBUS in a mapping.
+  int fd = open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return {};
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  Xxh64 hash;
+  std::vector<uint8_t> chunk(kHashChunk);
+  uint64_t total = 0;
+  for (;;) {
+    ssize_t got = read(fd, chunk.data(), chunk.size());
+    if (got < 0 && errno == EINTR) continue;
+    if (got < 0) {
+      close(fd);
+      return {};
+    }
+    if (got == 0) break;
+    hash.update(chunk.data(), static_cast<size_t>(got));
+    total += static_cast<uint64_t>(got);
+  }
+  close(fd);
+  if (total == 0) return {};
+
+  char key[kKeyLength + 1];
+  snprintf(key, sizeof(key), "%016llx", static_cast<unsigned long long>(hash.digest()));
+  return key;
+}
+
+std::string PcmCache::file_stamp(const std::string& file_path) {
+  struct stat st;
+  if (stat(file_path.c_str(), &st) != 0) return {};
+  return file_path + '\n' + std::to_string(st.st_size) + '\n' +
+         std::to_string(st.st_mtim.tv_sec) + '.' + std::to_string(st.st_mtim.tv_nsec);
+}
+
+std::string PcmCache::index_path(const std::string& stamp) const {
+  char name[17];
+  snprintf(name, sizeof(name), "%016llx",
+           static_cast<unsigned long long>(xxh64(
+               reinterpret_cast<const uint8_t*>(stamp.data()), stamp.size())));
+  return dir_ + "/" + name + ".idx";
+}
+
+std::string PcmCache::lookup(const std::string& stamp) const {
+  // An index file holds the 16-digit key followed by the full stamp, which
+  // must match: two stamps may share an index name.
+  MappedFile file;
+  if (!file.open(index_path(stamp))) return {};
+  if (file.size() != kKeyLength + stamp.size() ||
+      std::memcmp(file.data() + kKeyLength, stamp.data(), stamp.size()) != 0) {
+    return {};
+  }
+  return std::string(reinterpret_cast<const char*>(file.data()), kKeyLength);
+}
+
+void PcmCache::remember(const std::string& stamp, const std::string& key) const {
+  if (key.size() != kKeyLength) return;
+  const std::string path = index_path(stamp);
+  const std::string tmp_path = temp_path_for(path);
+  std::unique_ptr<FILE, FileCloser> file(fopen(tmp_path.c_str(), "wb"));
+  if (!file) return;
+  bool ok = fwrite(key.data(), 1, key.size(), file.get()) == key.size() &&
+            fwrite(stamp.data(), 1, stamp.size(), file.get()) == stamp.size();
+  ok = fclose(file.release()) == 0 && ok;
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) unlink(tmp_path.c_str());
+}
+
+std::string PcmCache::path_for(const std::string& key) const {
+  return dir_ + "/" + key + ".pcm";
+}
+
+bool PcmCache::contains(const std::string& key) const {
+  return access(path_for(key).c_str(), F_OK) == 0;
+}
+
+void PcmCache::store(const std::string& key, const std::vector<float>& pcm,
+                     int sample_rate) const {
+  const std::string path = path_for(key);
+  const std::string tmp_path = temp_path_for(path);
+
+  std::unique_ptr<FILE, FileCloser> file(fopen(tmp_path.c_str(), "wb"));
+  if (!file) {
+    throw std::runtime_error("Failed to create cache entry: " + tmp_path);
+  }
+  EntryHeader header{};
+  std::memcpy(header.magic, kMagic, sizeof(kMagic));
+  header.version = kFormatVersion;
+  header.sample_rate = static_cast<uint32_t>(sample_rate);
+  header.num_samples = pcm.size();
+  bool ok = fwrite(&header, sizeof(header), 1, file.get()) == 1 &&
+            fwrite(pcm.data(), sizeof(float), pcm.size(), file.get()) == pcm.size();
+  ok = fclose(file.release()) == 0 && ok;
+  if (!ok || rename(tmp_path.c_str(), path.c_str()) != 0) {
+    unlink(tmp_path.c_str());
+    throw std::runtime_error("Failed to write cache entry: " + path);
+  }
+}
+
+bool PcmCache::load(const std::string& key, std::vector<float>* pcm) const {
+  MappedFile file;
+  if (!file.open(path_for(key))) return false;
+  if (file.size() < sizeof(EntryHeader)) return false;
+
+  EntryHeader header;
+  std::memcpy(&header, file.data(), sizeof(header));
+  if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0 ||
+      header.version != kFormatVersion ||
+      header.num_samples != (file.size() - sizeof(header)) / sizeof(float)) {
+    return false;
+  }
+  pcm->resize(header.num_samples);
+  std::memcpy(pcm->data(), file.data() + sizeof(header),
+              header.num_samples * sizeof(float));
+  return true;
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace deeplayer {
+
+/**
+ * Content-addressed on-disk store of decoded 16kHz mono PCM.
+ *
+ * Entries are keyed by a 64-bit xxHash of the source file's bytes, so copies
+ * of the same file share one entry and a re-encoded file gets a new one. Each
+ * entry is <dir>/<key>.pcm: a small header followed by raw float samples.
+ *
+ * Hashing reads the whole file, so the key found for a file is also recorded
+ * under its stamp (path, size and modification time) in <dir>/<hash>.idx.
+ * Rescanning an unchanged library then only stats each file.
+ */
+class PcmCache {
+ public:
+  explicit PcmCache(std::string dir);
+
+  /**
+   * Compute the cache key of a file.
+   * @return 16 lowercase hex digits, or an empty string if the file cannot
+   *     be read.
+   */
+  static std::string content_key(const std::string& file_path);
+
+  /**
+   * Identity of a file as of its last change: path, size and modification
+   * time. Cheap to compute, unlike content_key.
+   * @return an empty string if the file cannot be stat'ed.
+   */
+  static std::string file_stamp(const std::string& file_path);
+
+  /** Content key recorded for stamp by remember(), or an empty string. */
+  std::string lookup(const std::string& stamp) const;
+
+  /**
+   * Record that the file identified by stamp has content key key. Best
+   * effort: a failed write only costs a rehash on the next lookup.
+   */
+  void remember(const std::string& stamp, const std::string& key) const;
+
+  /** Path of the entry for key, whether or not it exists. */
+  std::string path_for(const std::string& key) const;
+
+  /** Whether an entry for key exists. */
+  bool contains(const std::string& key) const;
+
+  /**
+   * Write an entry. The file is written under a temporary name and renamed,
+   * so concurrent readers never see a partial entry.
+   * @throws std::runtime_error on I/O failure.
+   */
+  void store(const std::string& key, const std::vector<float>& pcm,
+             int sample_rate) const;
+
+  /**
+   * Read an entry.
+   * @return false if the entry is missing, truncated or of another format
+   *     version.
+   */
+  bool load(const std::string& key, std::vector<float>* pcm) const;
+
+ private:
+  std::string dir_;
+
+  std::string index_path(const std::string& stamp) const;
+};
+
+}  // namespace deeplayer
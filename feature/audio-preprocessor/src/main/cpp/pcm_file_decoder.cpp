@@ -0,0 +1,325 @@
+#include "pcm_file_decoder.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "sinc_resampler.h"
+
+namespace deeplayer {
+
+namespace {
+
+/** Frames converted per step; keeps the resampler history in L1/L2 cache. */
+constexpr size_t kBlockFrames = 4096;
+constexpr int kMaxChannels = 64;
+constexpr double kMaxSampleRate = 768000.0;
+
+uint16_t le16(const uint8_t* p) { return static_cast<uint16_t>(p[0] | p[1] << 8); }
+
+uint32_t le32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 |
+         static_cast<uint32_t>(p[2]) << 16 | static_cast<uint32_t>(p[3]) << 24;
+}
+
+uint16_t be16(const uint8_t* p) { return static_cast<uint16_t>(p[0] << 8 | p[1]); }
+
+uint32_t be32(const uint8_t* p) {
+  return static_cast<uint32_t>(p[0]) << 24 | static_cast<uint32_t>(p[1]) << 16 |
+         static_cast<uint32_t>(p[2]) << 8 | static_cast<uint32_t>(p[3]);
+}
+
+/** 80-bit IEEE 754 extended precision, as used for the AIFF sample rate. */
+double be_extended(const uint8_t* p) {
+  int exponent = (p[0] & 0x7F) << 8 | p[1];
+  uint64_t mantissa = static_cast<uint64_t>(be32(p + 2)) << 32 | be32(p + 6);
+  if (exponent == 0 && mantissa == 0) return 0.0;
+  double value = std::ldexp(static_cast<double>(mantissa), exponent - 16383 - 63);
+  return (p[0] & 0x80) ? -value : value;
+}
+
+bool tag_is(const uint8_t* p, const char* tag) { return std::memcmp(p, tag, 4) == 0; }
+
+/** Read exactly n bytes at offset, retrying short reads. */
+bool read_at(int fd, uint64_t offset, uint8_t* dst, size_t n) {
+  while (n > 0) {
+    ssize_t got = pread(fd, dst, n, static_cast<off_t>(offset));
+    if (got < 0 && errno == EINTR) continue;
+    if (got <= 0) return false;
+    dst += got;
+    offset += static_cast<uint64_t>(got);
+    n -= static_cast<size_t>(got);
+  }
+  return true;
+}
+
+/**
+ * The bytes of a container: an in-memory copy, or a file descriptor read
+ * with pread. The parsers only read chunk headers and the fmt/COMM bodies,
+ * so parsing a file costs a few small reads however long it is.
+ */
+struct ByteSource {
+  const uint8_t* data;  // null to read from fd
+  int fd;
+  uint64_t size;
+
+  /** @return false unless all n bytes at offset are within size and read. */
+  bool read(uint64_t offset, uint8_t* dst, size_t n) const {
+    if (offset > size || n > size - offset) return false;
+    if (!data) return read_at(fd, offset, dst, n);
+    std::memcpy(dst, data + offset, n);
+    return true;
+  }
+};
+
+bool set_rate(double rate, PcmFileInfo* info) {
+  if (!(rate >= 1.0 && rate <= kMaxSampleRate) || rate != std::floor(rate)) {
+    return false;
+  }
+  info->sample_rate = static_cast<int>(rate);
+  return true;
+}
+
+bool finish(size_t data_offset, uint64_t data_bytes, uint64_t size, PcmFileInfo* info) {
+  if (info->layout.channels < 1 || info->layout.channels > kMaxChannels) return false;
+  if (data_offset > size) return false;
+  // Writers that stream to disk often leave the data size at 0 or 0xFFFFFFFF;
+  // trust the file length instead.
+  data_bytes = std::min<uint64_t>(data_bytes, size - data_offset);
+  size_t frame_bytes = bytes_per_sample(info->layout.format) * info->layout.channels;
+  info->data_offset = data_offset;
+  info->frames = static_cast<size_t>(data_bytes / frame_bytes);
+  return true;
+}
+
+bool parse_wav(const ByteSource& in, PcmFileInfo* info) {
+  const uint64_t size = in.size;
+  bool have_fmt = false;
+  uint64_t pos = 12;
+  while (pos + 8 <= size) {
+    uint8_t chunk[8];
+    if (!in.read(pos, chunk, sizeof(chunk))) return false;
+    uint32_t chunk_size = le32(chunk + 4);
+    uint64_t body = pos + 8;
+
+    if (tag_is(chunk, "fmt ")) {
+      if (chunk_size < 16 || body + chunk_size > size) return false;
+      // Nothing past the 40 bytes of WAVE_FORMAT_EXTENSIBLE is used.
+      uint8_t fmt[40];
+      if (!in.read(body, fmt, std::min<size_t>(chunk_size, sizeof(fmt)))) return false;
+      uint16_t format_tag = le16(fmt);
+      uint16_t block_align = le16(fmt + 12);
+      uint16_t bits = le16(fmt + 14);
+      if (format_tag == 0xFFFE) {
+        // WAVE_FORMAT_EXTENSIBLE: the real tag leads the SubFormat GUID.
+        if (chunk_size < 40) return false;
+        format_tag = le16(fmt + 24);
+      }
+      if (format_tag == 1) {
+        switch (bits) {
+          case 8: info->layout.format = SampleFormat::kU8; break;
+          case 16: info->layout.format = SampleFormat::kS16; break;
+          case 24: info->layout.format = SampleFormat::kS24; break;
+          case 32: info->layout.format = SampleFormat::kS32; break;
+          default: return false;
+        }
+      } else if (format_tag == 3) {
+        switch (bits) {
+          case 32: info->layout.format = SampleFormat::kF32; break;
+          case 64: info->layout.format = SampleFormat::kF64; break;
+          default: return false;
+        }
+      } else {
+        return false;
+      }
+      info->layout.channels = le16(fmt + 2);
+      info->layout.big_endian = false;
+      if (block_align != bytes_per_sample(info->layout.format) * info->layout.channels) {
+        return false;
+      }
+      if (!set_rate(le32(fmt + 4), info)) return false;
+      have_fmt = true;
+    } else if (tag_is(chunk, "data")) {
+      if (!have_fmt) return false;
+      return finish(static_cast<size_t>(body), chunk_size, size, info);
+    }
+    // Chunks are padded to an even size.
+    pos = body + chunk_size + (chunk_size & 1);
+  }
+  return false;
+}
+
+bool parse_aiff(const ByteSource& in, bool is_aifc, PcmFileInfo* info) {
+  const uint64_t size = in.size;
+  bool have_comm = false;
+  uint64_t data_offset = 0;
+  uint64_t data_bytes = 0;
+  bool have_ssnd = false;
+  uint32_t num_frames = 0;
+
+  uint64_t pos = 12;
+  while (pos + 8 <= size) {
+    uint8_t chunk[8];
+    if (!in.read(pos, chunk, sizeof(chunk))) return false;
+    uint32_t chunk_size = be32(chunk + 4);
+    uint64_t body = pos + 8;
+
+    if (tag_is(chunk, "COMM")) {
+      if (chunk_size < 18 || body + chunk_size > size) return false;
+      // 18 bytes, then the AIFC compression type.
+      uint8_t comm[22];
+      if (!in.read(body, comm, std::min<size_t>(chunk_size, sizeof(comm)))) return false;
+      info->layout.channels = be16(comm);
+      num_frames = be32(comm + 2);
+      int bits = be16(comm + 6);
+      if (!set_rate(be_extended(comm + 8), info)) return false;
+
+      // AIFF integer samples are big-endian and left-justified in whole bytes.
+      info->layout.big_endian = true;
+      if (bits < 1) {
+        return false;
+      } else if (bits <= 8) {
+        info->layout.format = SampleFormat::kS8;
+      } else if (bits <= 16) {
+        info->layout.format = SampleFormat::kS16;
+      } else if (bits <= 24) {
+        info->layout.format = SampleFormat::kS24;
+      } else if (bits <= 32) {
+        info->layout.format = SampleFormat::kS32;
+      } else {
+        return false;
+      }
+      if (is_aifc) {
+        if (chunk_size < 22) return false;
+        const uint8_t* compression = comm + 18;
+        if (tag_is(compression, "sowt")) {
+          info->layout.big_endian = false;
+        } else if (tag_is(compression, "fl32") || tag_is(compression, "FL32")) {
+          info->layout.format = SampleFormat::kF32;
+        } else if (tag_is(compression, "fl64") || tag_is(compression, "FL64")) {
+          info->layout.format = SampleFormat::kF64;
+        } else if (!tag_is(compression, "NONE")) {
+          return false;
+        }
+      }
+      have_comm = true;
+    } else if (tag_is(chunk, "SSND")) {
+      uint8_t ssnd_offset[4];
+      if (chunk_size < 8 || body + 8 > size || !in.read(body, ssnd_offset, 4)) return false;
+      uint32_t offset = be32(ssnd_offset);
+      data_offset = body + 8 + offset;
+      data_bytes = chunk_size - 8 >= offset ? chunk_size - 8 - offset : 0;
+      have_ssnd = true;
+    }
+    pos = body + chunk_size + (chunk_size & 1);
+  }
+
+  if (!have_comm || !have_ssnd) return false;
+  if (!finish(static_cast<size_t>(std::min<uint64_t>(data_offset, size)), data_bytes,
+              size, info)) {
+    return false;
+  }
+  info->frames = std::min<size_t>(info->frames, num_frames);
+  return true;
+}
+
+bool parse_header(const ByteSource& in, PcmFileInfo* info) {
+  uint8_t header[12];
+  if (!in.read(0, header, sizeof(header))) return false;
+  if (tag_is(header, "RIFF") && tag_is(header + 8, "WAVE")) return parse_wav(in, info);
+  if (tag_is(header, "FORM")) {
+    if (tag_is(header + 8, "AIFF")) return parse_aiff(in, false, info);
+    if (tag_is(header + 8, "AIFC")) return parse_aiff(in, true, info);
+  }
+  return false;
+}
+
+}  // namespace
+
+bool parse_pcm_header(const uint8_t* data, size_t size, PcmFileInfo* info) {
+  return parse_header(ByteSource{data, -1, size}, info);
+}
+
+PcmFile::PcmFile() = default;
+
+PcmFile::~PcmFile() {
+  if (fd_ >= 0) close(fd_);
+}
+
+bool PcmFile::open(const std::string& file_path, int target_rate) {
+  int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat st;
+  PcmFileInfo info;
+  // On 32-bit ABIs st_size is 64-bit and must not be truncated into size_t.
+  bool ok = fstat(fd, &st) == 0 && st.st_size > 0 &&
+            static_cast<uint64_t>(st.st_size) <= std::numeric_limits<size_t>::max() &&
+            parse_header(ByteSource{nullptr, fd, static_cast<uint64_t>(st.st_size)},
+                         &info) &&
+            SincResampler::is_supported(info.sample_rate, target_rate);
+  if (!ok) {
+    close(fd);
+    return false;
+  }
+#ifdef POSIX_FADV_SEQUENTIAL
+  posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+  if (fd_ >= 0) close(fd_);
+  fd_ = fd;
+  path_ = file_path;
+  target_rate_ = target_rate;
+  info_ = info;
+  return true;
+}
+
+size_t PcmFile::output_size() const {
+  // SincResampler::output_size without building the filter.
+  return static_cast<size_t>(
+      (static_cast<uint64_t>(info_.frames) * target_rate_ + info_.sample_rate - 1) /
+      info_.sample_rate);
+}
+
+void PcmFile::decode(std::vector<float>* out) const {
+  const size_t frame_bytes = bytes_per_sample(info_.layout.format) * info_.layout.channels;
+  std::vector<uint8_t> block(std::min(kBlockFrames, info_.frames) * frame_bytes);
+  // The n frames from first, read into block.
+  auto read_frames = [&](size_t first, size_t n) {
+    uint64_t offset = info_.data_offset + static_cast<uint64_t>(first) * frame_bytes;
+    if (!read_at(fd_, offset, block.data(), n * frame_bytes)) {
+      throw std::runtime_error("Audio file was truncated while decoding: " + path_);
+    }
+    return block.data();
+  };
+
+  if (info_.sample_rate == target_rate_) {
+    out->resize(info_.frames);
+    for (size_t done = 0; done < info_.frames;) {
+      size_t n = std::min(kBlockFrames, info_.frames - done);
+      pcm_to_mono(read_frames(done, n), n, info_.layout, out->data() + done);
+      done += n;
+    }
+    return;
+  }
+
+  // Each block is downmixed straight into the resampler's history, then
+  // filtered into out.
+  SincResampler resampler(info_.sample_rate, target_rate_);
+  out->clear();
+  out->reserve(resampler.output_size(info_.frames));
+  for (size_t done = 0; done < info_.frames;) {
+    size_t n = std::min(kBlockFrames, info_.frames - done);
+    pcm_to_mono(read_frames(done, n), n, info_.layout, resampler.input_buffer(n));
+    resampler.commit(n, out);
+    done += n;
+  }
+  resampler.flush(out);
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "pcm_kernels.h"
+
+namespace deeplayer {
+
+/** Location and encoding of the sample data inside an uncompressed file. */
+struct PcmFileInfo {
+  PcmLayout layout;
+  int sample_rate;
+  /** Byte offset of the first frame. */
+  size_t data_offset;
+  /** Number of complete frames available in the file. */
+  size_t frames;
+};
+
+/**
+ * Parse a RIFF/WAVE (PCM, IEEE float, WAVE_FORMAT_EXTENSIBLE) or AIFF/AIFC
+ * (NONE, sowt, fl32, fl64) header.
+ * @param data File contents.
+ * @param size Size of data in bytes.
+ * @param info Filled on success.
+ * @return false if the data is not an uncompressed container this decoder
+ *     understands.
+ */
+bool parse_pcm_header(const uint8_t* data, size_t size, PcmFileInfo* info);
+
+/**
+ * Fast path for uncompressed audio files: the samples are converted and
+ * resampled block by block into the output, without going through FFmpeg.
+ *
+ * open() parses the header once; output_size() and decode() reuse it. The
+ * file is read with pread rather than mapped. Music files can be rewritten
+ * or truncated by other apps while they are decoded, and touching a mapping
+ * past the new end of file raises SIGBUS, which would kill the process.
+ */
+class PcmFile {
+ public:
+  PcmFile();
+  ~PcmFile();
+
+  PcmFile(const PcmFile&) = delete;
+  PcmFile& operator=(const PcmFile&) = delete;
+
+  /**
+   * Open file_path and parse its header.
+   * @param target_rate Output sample rate in Hz.
+   * @return false if the file cannot be read or is not a supported PCM
+   *     container; the caller should fall back to a general decoder.
+   */
+  bool open(const std::string& file_path, int target_rate);
+
+  const std::string& path() const { return path_; }
+  const PcmFileInfo& info() const { return info_; }
+  int target_rate() const { return target_rate_; }
+
+  /** Number of samples decode() produces. */
+  size_t output_size() const;
+
+  /**
+   * Decode every frame to mono float samples in [-1.0, 1.0] at the target
+   * rate.
+   * @throws std::runtime_error if the file no longer holds the frames its
+   *     header promised, e.g. because it was truncated after open().
+   */
+  void decode(std::vector<float>* out) const;
+
+ private:
+  std::string path_;
+  int fd_ = -1;
+  int target_rate_ = 0;
+  PcmFileInfo info_{};
+};
+
+}  // namespace deeplayer
@@ -0,0 +1,295 @@
+#include "pcm_kernels.h"
+
+#include <cstring>
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace deeplayer {
+
+namespace {
+
+constexpr float kS16Scale = 1.0f / 32768.0f;
+constexpr float kS24Scale = 1.0f / 8388608.0f;
+constexpr float kS32Scale = 1.0f / 2147483648.0f;
+
+inline uint16_t load_u16(const uint8_t* p, bool big_endian) {
+  return big_endian ? static_cast<uint16_t>(p[0] << 8 | p[1])
+                    : static_cast<uint16_t>(p[1] << 8 | p[0]);
+}
+
+inline uint32_t load_u32(const uint8_t* p, bool big_endian) {
+  uint32_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return big_endian ? __builtin_bswap32(v) : v;
+}
+
+inline uint64_t load_u64(const uint8_t* p, bool big_endian) {
+  uint64_t v;
+  std::memcpy(&v, p, sizeof(v));
+  return big_endian ? __builtin_bswap64(v) : v;
+}
+
+inline float load_sample(const uint8_t* p, SampleFormat format, bool big_endian) {
+  switch (format) {
+    case SampleFormat::kU8:
+      return (static_cast<int>(p[0]) - 128) * (1.0f / 128.0f);
+    case SampleFormat::kS8:
+      return static_cast<int8_t>(p[0]) * (1.0f / 128.0f);
+    case SampleFormat::kS16:
+      return static_cast<int16_t>(load_u16(p, big_endian)) * kS16Scale;
+    case SampleFormat::kS24: {
+      uint32_t v = big_endian ? (p[0] << 16 | p[1] << 8 | p[2])
+                              : (p[2] << 16 | p[1] << 8 | p[0]);
+      // Sign-extend from bit 23.
+      return (static_cast<int32_t>(v << 8) >> 8) * kS24Scale;
+    }
+    case SampleFormat::kS32:
+      return static_cast<int32_t>(load_u32(p, big_endian)) * kS32Scale;
+    case SampleFormat::kF32: {
+      uint32_t bits = load_u32(p, big_endian);
+      float v;
+      std::memcpy(&v, &bits, sizeof(v));
+      return v;
+    }
+    case SampleFormat::kF64: {
+      uint64_t bits = load_u64(p, big_endian);
+      double v;
+      std::memcpy(&v, &bits, sizeof(v));
+      return static_cast<float>(v);
+    }
+  }
+  return 0.0f;
+}
+
+void to_mono_scalar(const uint8_t* src, size_t frames, const PcmLayout& layout,
+                    float* dst) {
+  const size_t sample_bytes = bytes_per_sample(layout.format);
+  const float inv_channels = 1.0f / layout.channels;
+  for (size_t i = 0; i < frames; i++) {
+    float sum = 0.0f;
+    for (int ch = 0; ch < layout.channels; ch++) {
+      sum += load_sample(src, layout.format, layout.big_endian);
+      src += sample_bytes;
+    }
+    dst[i] = sum * inv_channels;
+  }
+}
+
+// Vector kernels below convert the bulk of the frames and return how many they
+// handled; the caller finishes the tail with to_mono_scalar.
+
+// Sample data starts wherever the container put it, so the kernels load bytes
+// and reinterpret the registers instead of casting src to wider types.
+
+#if defined(__ARM_NEON)
+
+inline int16x8_t swap_bytes(int16x8_t v) {
+  return vreinterpretq_s16_u8(vrev16q_u8(vreinterpretq_u8_s16(v)));
+}
+
+inline int16x8_t load_s16(const uint8_t* p) { return vreinterpretq_s16_u8(vld1q_u8(p)); }
+
+inline float32x4_t load_f32(const uint8_t* p) { return vreinterpretq_f32_u8(vld1q_u8(p)); }
+
+size_t s16_to_mono(const uint8_t* src, size_t frames, int channels,
+                   bool big_endian, float* dst) {
+  size_t i = 0;
+  if (channels == 1) {
+    const float32x4_t scale = vdupq_n_f32(kS16Scale);
+    for (; i + 8 <= frames; i += 8) {
+      int16x8_t v = load_s16(src + 2 * i);
+      if (big_endian) v = swap_bytes(v);
+      vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+      vst1q_f32(dst + i + 4,
+                vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+  } else {
+    const float32x4_t scale = vdupq_n_f32(0.5f * kS16Scale);
+    for (; i + 8 <= frames; i += 8) {
+      const uint8_t* p = src + 4 * i;
+      int16x8x2_t v = vuzpq_s16(load_s16(p), load_s16(p + 16));
+      if (big_endian) {
+        v.val[0] = swap_bytes(v.val[0]);
+        v.val[1] = swap_bytes(v.val[1]);
+      }
+      int32x4_t lo = vaddl_s16(vget_low_s16(v.val[0]), vget_low_s16(v.val[1]));
+      int32x4_t hi = vaddl_s16(vget_high_s16(v.val[0]), vget_high_s16(v.val[1]));
+      vst1q_f32(dst + i, vmulq_f32(vcvtq_f32_s32(lo), scale));
+      vst1q_f32(dst + i + 4, vmulq_f32(vcvtq_f32_s32(hi), scale));
+    }
+  }
+  return i;
+}
+
+size_t f32_stereo_to_mono(const uint8_t* src, size_t frames, float* dst) {
+  const float32x4_t half = vdupq_n_f32(0.5f);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const uint8_t* p = src + 8 * i;
+    float32x4x2_t v = vuzpq_f32(load_f32(p), load_f32(p + 16));
+    vst1q_f32(dst + i, vmulq_f32(vaddq_f32(v.val[0], v.val[1]), half));
+  }
+  return i;
+}
+
+#elif defined(__SSE2__)
+
+inline __m128i swap_bytes(__m128i v) {
+  return _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+}
+
+size_t s16_to_mono(const uint8_t* src, size_t frames, int channels,
+                   bool big_endian, float* dst) {
+  size_t i = 0;
+  if (channels == 1) {
+    const __m128 scale = _mm_set1_ps(kS16Scale);
+    for (; i + 8 <= frames; i += 8) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 2 * i));
+      if (big_endian) v = swap_bytes(v);
+      // Widen with sign by placing each sample in the high half of a lane.
+      __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+      __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), scale));
+      _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), scale));
+    }
+  } else {
+    const __m128 scale = _mm_set1_ps(0.5f * kS16Scale);
+    const __m128i ones = _mm_set1_epi16(1);
+    for (; i + 4 <= frames; i += 4) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + 4 * i));
+      if (big_endian) v = swap_bytes(v);
+      // L*1 + R*1 per frame, widened to int32.
+      __m128i sum = _mm_madd_epi16(v, ones);
+      _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(sum), scale));
+    }
+  }
+  return i;
+}
+
+inline __m128 load_f32(const uint8_t* p) {
+  return _mm_castsi128_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+}
+
+size_t f32_stereo_to_mono(const uint8_t* src, size_t frames, float* dst) {
+  const __m128 half = _mm_set1_ps(0.5f);
+  size_t i = 0;
+  for (; i + 4 <= frames; i += 4) {
+    const uint8_t* p = src + 8 * i;
+    __m128 a = load_f32(p);
+    __m128 b = load_f32(p + 16);
+    __m128 left = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 right = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+  }
+  return i;
+}
+
+#else
+
+size_t s16_to_mono(const uint8_t*, size_t, int, bool, float*) { return 0; }
+size_t f32_stereo_to_mono(const uint8_t*, size_t, float*) { return 0; }
+
+#endif
+
+}  // namespace
+
+size_t bytes_per_sample(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kU8:
+    case SampleFormat::kS8:
+      return 1;
+    case SampleFormat::kS16:
+      return 2;
+    case SampleFormat::kS24:
+      return 3;
+    case SampleFormat::kS32:
+    case SampleFormat::kF32:
+      return 4;
+    case SampleFormat::kF64:
+      return 8;
+  }
+  return 0;
+}
+
+void pcm_to_mono(const uint8_t* src, size_t frames, const PcmLayout& layout,
+                 float* dst) {
+  size_t done = 0;
+  if (layout.format == SampleFormat::kS16 &&
+      (layout.channels == 1 || layout.channels == 2)) {
+    done = s16_to_mono(src, frames, layout.channels, layout.big_endian, dst);
+  } else if (layout.format == SampleFormat::kF32 && !layout.big_endian) {
+    if (layout.channels == 1) {
+      std::memcpy(dst, src, frames * sizeof(float));
+      return;
+    }
+    if (layout.channels == 2) done = f32_stereo_to_mono(src, frames, dst);
+  }
+  if (done < frames) {
+    const size_t frame_bytes = bytes_per_sample(layout.format) * layout.channels;
+    to_mono_scalar(src + done * frame_bytes, frames - done, layout, dst + done);
+  }
+}
+
+void dot_product_x4(const float* const a[4], const float* const b[4], int n,
+                    float* out) {
+  // The four accumulators are spelled out so they stay in registers.
+  const float* a0 = a[0];
+  const float* a1 = a[1];
+  const float* a2 = a[2];
+  const float* a3 = a[3];
+  const float* b0 = b[0];
+  const float* b1 = b[1];
+  const float* b2 = b[2];
+  const float* b3 = b[3];
+#if defined(__ARM_NEON)
+  float32x4_t acc0 = vdupq_n_f32(0.0f);
+  float32x4_t acc1 = vdupq_n_f32(0.0f);
+  float32x4_t acc2 = vdupq_n_f32(0.0f);
+  float32x4_t acc3 = vdupq_n_f32(0.0f);
+  for (int i = 0; i < n; i += 4) {
+    acc0 = vmlaq_f32(acc0, vld1q_f32(a0 + i), vld1q_f32(b0 + i));
+    acc1 = vmlaq_f32(acc1, vld1q_f32(a1 + i), vld1q_f32(b1 + i));
+    acc2 = vmlaq_f32(acc2, vld1q_f32(a2 + i), vld1q_f32(b2 + i));
+    acc3 = vmlaq_f32(acc3, vld1q_f32(a3 + i), vld1q_f32(b3 + i));
+  }
+#if defined(__aarch64__)
+  vst1q_f32(out, vpaddq_f32(vpaddq_f32(acc0, acc1), vpaddq_f32(acc2, acc3)));
+#else
+  float32x2_t sum0 = vpadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+  float32x2_t sum1 = vpadd_f32(vget_low_f32(acc1), vget_high_f32(acc1));
+  float32x2_t sum2 = vpadd_f32(vget_low_f32(acc2), vget_high_f32(acc2));
+  float32x2_t sum3 = vpadd_f32(vget_low_f32(acc3), vget_high_f32(acc3));
+  vst1_f32(out, vpadd_f32(sum0, sum1));
+  vst1_f32(out + 2, vpadd_f32(sum2, sum3));
+#endif
+#elif defined(__SSE2__)
+  __m128 acc0 = _mm_setzero_ps();
+  __m128 acc1 = _mm_setzero_ps();
+  __m128 acc2 = _mm_setzero_ps();
+  __m128 acc3 = _mm_setzero_ps();
+  for (int i = 0; i < n; i += 4) {
+    acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a0 + i), _mm_loadu_ps(b0 + i)));
+    acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a1 + i), _mm_loadu_ps(b1 + i)));
+    acc2 = _mm_add_ps(acc2, _mm_mul_ps(_mm_loadu_ps(a2 + i), _mm_loadu_ps(b2 + i)));
+    acc3 = _mm_add_ps(acc3, _mm_mul_ps(_mm_loadu_ps(a3 + i), _mm_loadu_ps(b3 + i)));
+  }
+  // Transpose-add so lane j holds the horizontal sum of accj.
+  __m128 t0 = _mm_add_ps(_mm_unpacklo_ps(acc0, acc1), _mm_unpackhi_ps(acc0, acc1));
+  __m128 t1 = _mm_add_ps(_mm_unpacklo_ps(acc2, acc3), _mm_unpackhi_ps(acc2, acc3));
+  _mm_storeu_ps(out, _mm_add_ps(_mm_movelh_ps(t0, t1), _mm_movehl_ps(t1, t0)));
+#else
+  out[0] = out[1] = out[2] = out[3] = 0.0f;
+  for (int i = 0; i < n; i++) {
+    out[0] += a0[i] * b0[i];
+    out[1] += a1[i] * b1[i];
+    out[2] += a2[i] * b2[i];
+    out[3] += a3[i] * b3[i];
+  }
+#endif
+}
+
+}  // namespace deeplayer
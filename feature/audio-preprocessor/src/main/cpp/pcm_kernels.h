@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace deeplayer {
+
+/** Sample encodings understood by the PCM conversion kernels. */
+enum class SampleFormat {
+  kU8,   // unsigned 8-bit (WAV)
+  kS8,   // signed 8-bit (AIFF)
+  kS16,
+  kS24,  // packed, 3 bytes per sample
+  kS32,
+  kF32,
+  kF64,
+};
+
+/** Interleaved PCM layout as stored in a file. */
+struct PcmLayout {
+  SampleFormat format;
+  int channels;
+  bool big_endian;
+};
+
+/** Size in bytes of a single sample of the given format. */
+size_t bytes_per_sample(SampleFormat format);
+
+/**
+ * Convert interleaved PCM frames to mono float in [-1.0, 1.0], averaging all
+ * channels. Mono and stereo 16-bit and float32 input use NEON / SSE2 kernels;
+ * other layouts fall back to a scalar loop.
+ * @param src Start of the first frame. Need not be aligned.
+ * @param frames Number of frames to convert.
+ * @param layout Encoding of src.
+ * @param dst Output buffer of at least frames floats.
+ */
+void pcm_to_mono(const uint8_t* src, size_t frames, const PcmLayout& layout,
+                 float* dst);
+
+/**
+ * Four independent dot products of length n (a multiple of 4), interleaved so
+ * their accumulations overlap in the pipeline: out[j] = a[j] . b[j].
+ */
+void dot_product_x4(const float* const a[4], const float* const b[4], int n,
+                    float* out);
+
+}  // namespace deeplayer
@@ -0,0 +1,170 @@
+#include "sinc_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#include "pcm_kernels.h"
+
+namespace deeplayer {
+
+namespace {
+
+/** Zeroth-order modified Bessel function of the first kind. */
+double bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; k < 32; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+    if (term < sum * 1e-12) break;
+  }
+  return sum;
+}
+
+}  // namespace
+
+bool SincResampler::is_supported(int src_rate, int dst_rate) {
+  if (src_rate <= 0 || dst_rate <= 0) return false;
+  return dst_rate / std::gcd(src_rate, dst_rate) <= kMaxPhases;
+}
+
+SincResampler::SincResampler(int src_rate, int dst_rate) {
+  if (!is_supported(src_rate, dst_rate)) {
+    throw std::invalid_argument("Unsupported resampling ratio");
+  }
+  int g = std::gcd(src_rate, dst_rate);
+  up_ = dst_rate / g;
+  down_ = src_rate / g;
+  step_ = down_ / up_;
+  step_phase_ = down_ % up_;
+  init_filter();
+
+  // Zero history to the left of the first sample so the first outputs see a
+  // full window.
+  history_.assign(left_taps_ - 1, 0.0f);
+  history_start_ = -(left_taps_ - 1);
+}
+
+SincResampler::~SincResampler() = default;
+
+void SincResampler::init_filter() {
+  if (up_ == down_) {
+    left_taps_ = 1;
+    taps_ = 4;
+    coeffs_ = {1.0f, 0.0f, 0.0f, 0.0f};
+    return;
+  }
+
+  // Filter positions are measured in input samples. When downsampling, the
+  // cutoff scales with the ratio so the output Nyquist band is kept.
+  const double scale = std::min(1.0, static_cast<double>(up_) / down_);
+  const double cutoff = kCutoff * scale;
+  const double half_width = kZeroCrossings / cutoff;
+  left_taps_ = static_cast<int>(std::ceil(half_width)) + 1;
+  taps_ = left_taps_ + static_cast<int>(std::ceil(half_width)) + 1;
+  taps_ = (taps_ + 3) & ~3;
+
+  const double window_norm = 1.0 / bessel_i0(kKaiserBeta);
+  coeffs_.assign(static_cast<size_t>(up_) * taps_, 0.0f);
+  std::vector<double> h(taps_);
+  for (int p = 0; p < up_; p++) {
+    float* phase = coeffs_.data() + static_cast<size_t>(p) * taps_;
+    double sum = 0.0;
+    std::fill(h.begin(), h.end(), 0.0);
+    for (int k = 0; k < taps_; k++) {
+      double x = (k - (left_taps_ - 1)) - static_cast<double>(p) / up_;
+      double t = x / half_width;
+      if (std::fabs(t) >= 1.0) continue;
+      double arg = M_PI * cutoff * x;
+      double sinc = arg == 0.0 ? 1.0 : std::sin(arg) / arg;
+      double window = bessel_i0(kKaiserBeta * std::sqrt(1.0 - t * t)) * window_norm;
+      h[k] = cutoff * sinc * window;
+      sum += h[k];
+    }
+    // Unity DC gain for every phase.
+    for (int k = 0; k < taps_; k++) {
+      phase[k] = static_cast<float>(h[k] / sum);
+    }
+  }
+}
+
+size_t SincResampler::output_size(size_t input_size) const {
+  return static_cast<size_t>(
+      (static_cast<uint64_t>(input_size) * up_ + down_ - 1) / down_);
+}
+
+float* SincResampler::input_buffer(size_t count) {
+  size_t old_size = history_.size();
+  history_.resize(old_size + count);
+  return history_.data() + old_size;
+}
+
+void SincResampler::commit(size_t count, std::vector<float>* output) {
+  consumed_ += static_cast<int64_t>(count);
+  emit(std::numeric_limits<int64_t>::max(), output);
+
+  // Drop input that no future output can reach.
+  int64_t drop = next_index_ - (left_taps_ - 1) - history_start_;
+  if (drop > 0) {
+    drop = std::min<int64_t>(drop, static_cast<int64_t>(history_.size()));
+    history_.erase(history_.begin(), history_.begin() + drop);
+    history_start_ += drop;
+  }
+}
+
+void SincResampler::process(const float* input, size_t count,
+                            std::vector<float>* output) {
+  // An empty input may come with a null pointer, which memcpy must not see.
+  if (count > 0) std::memcpy(input_buffer(count), input, count * sizeof(float));
+  commit(count, output);
+}
+
+void SincResampler::flush(std::vector<float>* output) {
+  std::fill_n(input_buffer(taps_), taps_, 0.0f);
+  emit(static_cast<int64_t>(output_size(static_cast<size_t>(consumed_))), output);
+  history_.clear();
+}
+
+void SincResampler::emit(int64_t limit, std::vector<float>* output) {
+  const int64_t available = history_start_ + static_cast<int64_t>(history_.size());
+  // Outputs are computed four at a time. A partial group at the end is padded
+  // with copies of its first entry so every sample goes through the same
+  // kernel, whatever the block boundaries.
+  const float* windows[4];
+  const float* phases[4];
+  float results[4];
+  int pending = 0;
+  while (produced_ < limit &&
+         next_index_ - (left_taps_ - 1) + taps_ <= available) {
+    windows[pending] =
+        history_.data() + (next_index_ - (left_taps_ - 1) - history_start_);
+    phases[pending] = coeffs_.data() + static_cast<size_t>(phase_) * taps_;
+    if (++pending == 4) {
+      dot_product_x4(windows, phases, taps_, results);
+      output->insert(output->end(), results, results + 4);
+      pending = 0;
+    }
+    produced_++;
+
+    next_index_ += step_;
+    phase_ += step_phase_;
+    if (phase_ >= up_) {
+      phase_ -= up_;
+      next_index_++;
+    }
+  }
+  if (pending > 0) {
+    for (int j = pending; j < 4; j++) {
+      windows[j] = windows[0];
+      phases[j] = phases[0];
+    }
+    dot_product_x4(windows, phases, taps_, results);
+    output->insert(output->end(), results, results + pending);
+  }
+}
+
+}  // namespace deeplayer
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace deeplayer {
+
+/**
+ * Streaming polyphase windowed-sinc resampler for mono float PCM.
+ *
+ * The rate ratio is reduced to up/down and one Kaiser-windowed sinc filter is
+ * precomputed per output phase, so each output sample is a single SIMD dot
+ * product over the input history. Unlike Resampler it has no FFmpeg
+ * dependency, and callers can write input directly into its history buffer
+ * (input_buffer / commit) to avoid a staging copy.
+ */
+class SincResampler {
+ public:
+  /** Whether the ratio src_rate:dst_rate needs a manageable number of phases. */
+  static bool is_supported(int src_rate, int dst_rate);
+
+  SincResampler(int src_rate, int dst_rate);
+  ~SincResampler();
+
+  SincResampler(const SincResampler&) = delete;
+  SincResampler& operator=(const SincResampler&) = delete;
+
+  /** Number of output samples produced for input_size input samples in total. */
+  size_t output_size(size_t input_size) const;
+
+  /**
+   * Reserve room for count input samples and return where to write them. The
+   * pointer is valid until the next call on this resampler.
+   */
+  float* input_buffer(size_t count);
+
+  /** Resample the count samples written through input_buffer into output. */
+  void commit(size_t count, std::vector<float>* output);
+
+  /** Resample count samples from input, appending to output. */
+  void process(const float* input, size_t count, std::vector<float>* output);
+
+  /** Emit the remaining output samples, treating the input as zero-padded. */
+  void flush(std::vector<float>* output);
+
+ private:
+  /** Maximum number of filter phases (the reduced "up" factor). */
+  static constexpr int kMaxPhases = 4096;
+  /** Filter half-width in zero crossings of the cutoff frequency. */
+  static constexpr int kZeroCrossings = 8;
+  /** Cutoff as a fraction of the lower Nyquist frequency. */
+  static constexpr double kCutoff = 0.9;
+  /** Kaiser window shape parameter. */
+  static constexpr double kKaiserBeta = 6.0;
+
+  int up_;
+  int down_;
+  /** Input advance per output sample, split into whole samples and phases. */
+  int step_;
+  int step_phase_;
+  /** Taps per phase, padded to a multiple of 4. */
+  int taps_;
+  /** Taps to the left of (and including) the centre sample. */
+  int left_taps_;
+  std::vector<float> coeffs_;
+
+  std::vector<float> history_;
+  /** Stream index of history_[0]; negative while the left padding is kept. */
+  int64_t history_start_;
+  /** Stream index of the input sample at or before the next output. */
+  int64_t next_index_ = 0;
+  /** Sub-sample position of the next output, in units of 1/up_. */
+  int phase_ = 0;
+  int64_t consumed_ = 0;
+  int64_t produced_ = 0;
+
+  void init_filter();
+  void emit(int64_t limit, std::vector<float>* output);
+};
+
+}  // namespace deeplayer
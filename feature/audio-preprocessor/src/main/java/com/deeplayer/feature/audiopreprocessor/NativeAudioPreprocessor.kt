@@ -0,0 +1,201 @@
+package com.deeplayer.feature.audiopreprocessor
+
+import com.deeplayer.core.contracts.AudioPreprocessor
+import com.deeplayer.core.contracts.FrameFormat
+import com.deeplayer.core.contracts.FrameMatrix
+import java.io.File
+
+/**
+ * [AudioPreprocessor] backed by the native decoder in libaudio_preprocessor. Uncompressed WAV and
+ * AIFF files are read and converted directly; other formats go through FFmpeg when the library was
+ * built with it.
+ *
+ * [decodeToPcm] and [decodeBatch] may be called from any thread; [extractMelSpectrogram] is not
+ * thread-safe.
+ *
+ * @param fallback decodes files the native decoder rejects, such as compressed formats in a build
+ *   without FFmpeg.
+ */
+class NativeAudioPreprocessor(private val fallback: AudioPreprocessor? = null) :
+  AudioPreprocessor, AutoCloseable {
+
+  /** Receives the files of a [decodeBatch] call as they finish. */
+  fun interface BatchCallback {
+    /**
+     * Called on the thread running [decodeBatch], in completion order.
+     *
+     * @param index position of the file in the input list.
+     * @param pcm 16 kHz mono samples; null on error, and in cache mode unless the file was decoded
+     *   by the fallback.
+     * @param cacheKey key of the cache entry holding the samples, in cache mode. Null for files
+     *   decoded by the fallback, which are not cached.
+     * @param error failure message, or null on success.
+     * @return false to cancel the files not yet delivered.
+     */
+    fun onDecoded(index: Int, pcm: FloatArray?, cacheKey: String?, error: String?): Boolean
+  }
+
+  private var handle: Long = nativeCreate()
+
+  override fun decodeToPcm(filePath: String): FloatArray {
+    check(handle != 0L) { "NativeAudioPreprocessor is closed" }
+    if (fallback == null) return nativeDecodeToPcm(handle, filePath)
+    return try {
+      nativeDecodeToPcm(handle, filePath)
+    } catch (e: RuntimeException) {
+      fallback.decodeToPcm(filePath)
+    }
+  }
+
+  /** 80-band log-mel spectrogram of 16 kHz mono [pcm], flattened `[frames × 80]`. */
+  fun extractMelSpectrogram(pcm: FloatArray): FloatArray {
+    check(handle != 0L) { "NativeAudioPreprocessor is closed" }
+    return nativeExtractMelSpectrogram(handle, pcm)
+  }
+
+  /**
+   * [extractMelSpectrogram] encoded natively in [format], so only the compact form crosses JNI.
+   * FLOAT16 keeps log-mel values within 0.01; INT8 trades more precision for a quarter of the size.
+   */
+  fun extractMelSpectrogram(pcm: FloatArray, format: FrameFormat): FrameMatrix {
+    check(handle != 0L) { "NativeAudioPreprocessor is closed" }
+    return when (format) {
+      FrameFormat.FLOAT32 -> {
+        val mel = nativeExtractMelSpectrogram(handle, pcm)
+        FrameMatrix.Float32(mel, mel.size / MEL_BANDS, MEL_BANDS)
+      }
+      FrameFormat.FLOAT16 -> {
+        val mel = nativeExtractMelSpectrogramF16(handle, pcm)
+        FrameMatrix.Float16(mel, mel.size / MEL_BANDS, MEL_BANDS)
+      }
+      FrameFormat.INT8 -> {
+        // The per-frame parameters are filled in natively, so size them up front.
+        val frames = melFrameCount(pcm.size)
+        val scales = FloatArray(frames)
+        val offsets = FloatArray(frames)
+        val codes = nativeExtractMelSpectrogramU8(handle, pcm, scales, offsets)
+        FrameMatrix.Int8(codes, scales, offsets, frames, MEL_BANDS)
+      }
+    }
+  }
+
+  /**
+   * Decode [paths] on a native worker pool with work stealing, for library scans.
+   *
+   * Blocks until every file has been delivered to [callback] or the batch is cancelled; call it
+   * from a background thread. At most [maxBufferedBytes] of decoded PCM is held at once, or one
+   * file on its own if it is larger. Workers wait for room, so a slow callback throttles decoding.
+   *
+   * With [cacheDir], each file is stored in a content-addressed cache and only its key is
+   * delivered. Files already cached are not decoded again, and files unchanged since the last scan
+   * (same path, size and modification time) are not read at all. Use [readCachedPcm] to load them.
+   *
+   * Files the native decoder rejects, such as MP3, FLAC or AAC in a build without FFmpeg, are
+   * delivered with an error when there is no [fallback]. With one, they are held back and decoded
+   * one at a time by [fallback] on the calling thread after the native pass, then delivered with
+   * their samples, or with the fallback's error. Their samples are not cached and do not count
+   * against [maxBufferedBytes].
+   *
+   * @param numThreads worker threads; 0 for one per core.
+   * @return number of files delivered.
+   */
+  fun decodeBatch(
+    paths: List<String>,
+    cacheDir: File? = null,
+    numThreads: Int = 0,
+    maxBufferedBytes: Long = DEFAULT_MAX_BUFFERED_BYTES,
+    callback: BatchCallback,
+  ): Int {
+    cacheDir?.mkdirs()
+    val pathArray = paths.toTypedArray()
+    if (fallback == null) {
+      return nativeDecodeBatch(pathArray, cacheDir?.path, numThreads, maxBufferedBytes, callback)
+    }
+
+    // Rejected files are only recorded during the native pass, so the fallback never runs while
+    // native workers hold decoded PCM.
+    val rejected = mutableListOf<Pair<Int, String>>()
+    var cancelled = false
+    val deferRejected = BatchCallback { index, pcm, cacheKey, error ->
+      if (error != null) {
+        rejected.add(index to error)
+        true
+      } else {
+        callback.onDecoded(index, pcm, cacheKey, null).also { cancelled = !it }
+      }
+    }
+    val nativeDelivered =
+      nativeDecodeBatch(pathArray, cacheDir?.path, numThreads, maxBufferedBytes, deferRejected)
+
+    var delivered = nativeDelivered - rejected.size
+    for ((index, nativeError) in rejected) {
+      if (cancelled) break
+      var error: String? = null
+      val pcm =
+        try {
+          fallback.decodeToPcm(paths[index])
+        } catch (e: Exception) {
+          error = e.message ?: nativeError
+          null
+        }
+      delivered++
+      cancelled = !callback.onDecoded(index, pcm, null, error)
+    }
+    return delivered
+  }
+
+  /** Samples stored by [decodeBatch] under [cacheKey], or null if missing or unreadable. */
+  fun readCachedPcm(cacheDir: File, cacheKey: String): FloatArray? =
+    nativeReadCachedPcm(cacheDir.path, cacheKey)
+
+  override fun close() {
+    if (handle != 0L) {
+      nativeDestroy(handle)
+      handle = 0L
+    }
+  }
+
+  private external fun nativeCreate(): Long
+
+  private external fun nativeDestroy(handle: Long)
+
+  private external fun nativeDecodeToPcm(handle: Long, filePath: String): FloatArray
+
+  private external fun nativeExtractMelSpectrogram(handle: Long, pcm: FloatArray): FloatArray
+
+  private external fun nativeExtractMelSpectrogramF16(handle: Long, pcm: FloatArray): ShortArray
+
+  private external fun nativeExtractMelSpectrogramU8(
+    handle: Long,
+    pcm: FloatArray,
+    scales: FloatArray,
+    offsets: FloatArray,
+  ): ByteArray
+
+  private external fun nativeDecodeBatch(
+    paths: Array<String>,
+    cacheDir: String?,
+    numThreads: Int,
+    maxBufferedBytes: Long,
+    callback: BatchCallback,
+  ): Int
+
+  private external fun nativeReadCachedPcm(cacheDir: String, cacheKey: String): FloatArray?
+
+  companion object {
+    /** Default cap on decoded PCM held in memory by [decodeBatch] (about 70 min of audio). */
+    const val DEFAULT_MAX_BUFFERED_BYTES: Long = 256L shl 20
+
+    /** Mel bands per frame, as in MelSpectrogram::kNumMelBands. */
+    const val MEL_BANDS = 80
+
+    /** Number of mel frames produced for [numSamples] samples. */
+    fun melFrameCount(numSamples: Int): Int = nativeMelFrameCount(numSamples)
+
+    @JvmStatic private external fun nativeMelFrameCount(numSamples: Int): Int
+
+    init {
+      System.loadLibrary("audio_preprocessor")
+    }
+  }
+}
@@ -0,0 +1,193 @@
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "audio_decoder.h"
+#include "batch_decoder.h"
+#include "native_test.h"
+#include "sinc_resampler.h"
+#include "test_files.h"
+
+namespace {
+
+using deeplayer::BatchItem;
+using deeplayer::BatchOptions;
+using test_files::TempDir;
+
+/** A library of WAV files of different lengths and rates. */
+struct Library {
+  TempDir dir;
+  std::vector<std::string> paths;
+  std::vector<size_t> expected_samples;
+
+  explicit Library(int count) {
+    for (int i = 0; i < count; i++) {
+      // Every third file needs resampling.
+      bool resample = i % 3 == 2;
+      int rate = resample ? 44100 : 16000;
+      size_t frames = 1000 + 2500 * static_cast<size_t>(i);
+      std::string path = dir.file("track" + std::to_string(i) + ".wav");
+      test_files::write_file(path, test_files::make_wav(frames, rate, resample ? 2 : 1, i));
+      paths.push_back(path);
+      expected_samples.push_back(
+          resample ? deeplayer::SincResampler(44100, 16000).output_size(frames) : frames);
+    }
+  }
+};
+
+void test_decodes_every_file() {
+  Library library(10);
+  for (int threads : {1, 3, 8, 0}) {
+    BatchOptions options;
+    options.num_threads = threads;
+    std::vector<int> seen(library.paths.size(), 0);
+    size_t delivered = deeplayer::decode_batch(library.paths, options, [&](BatchItem& item) {
+      seen[item.index]++;
+      EXPECT(item.error.empty(), "file %zu: %s", item.index, item.error.c_str());
+      EXPECT(item.pcm.size() == library.expected_samples[item.index],
+             "file %zu: %zu samples, expected %zu", item.index, item.pcm.size(),
+             library.expected_samples[item.index]);
+      EXPECT(item.cache_key.empty() && !item.cache_hit, "cache fields set without a cache");
+      return true;
+    });
+    EXPECT(delivered == library.paths.size(), "threads=%d: delivered %zu", threads,
+           delivered);
+    for (size_t i = 0; i < seen.size(); i++) {
+      EXPECT(seen[i] == 1, "threads=%d: file %zu delivered %d times", threads, i, seen[i]);
+    }
+  }
+
+  // Same samples as decoding the files one by one.
+  deeplayer::AudioDecoder decoder;
+  BatchOptions options;
+  options.num_threads = 4;
+  deeplayer::decode_batch(library.paths, options, [&](BatchItem& item) {
+    EXPECT(item.pcm == decoder.decode(library.paths[item.index]).data,
+           "file %zu differs from AudioDecoder::decode", item.index);
+    return true;
+  });
+  EXPECT(deeplayer::decode_batch({}, options, [](BatchItem&) { return true; }) == 0,
+         "empty batch");
+}
+
+void test_failures_are_per_file() {
+  Library library(3);
+  std::vector<std::string> paths = library.paths;
+  std::string missing = library.dir.file("missing.mp3");
+  std::string garbage = library.dir.file("garbage.mp3");
+  test_files::write_file(garbage, std::vector<uint8_t>(4000, 0x42));
+  paths.push_back(missing);
+  paths.push_back(garbage);
+
+  // A missing file reads the same with and without a cache, and the same as
+  // decoding it directly.
+  std::string direct_error;
+  try {
+    deeplayer::AudioDecoder().decode(missing);
+  } catch (const std::exception& e) {
+    direct_error = e.what();
+  }
+  EXPECT(direct_error == "Failed to open audio file: " + missing, "direct: %s",
+         direct_error.c_str());
+
+  TempDir cache;
+  for (bool use_cache : {false, true}) {
+    BatchOptions options;
+    options.num_threads = 2;
+    if (use_cache) options.cache_dir = cache.path();
+    size_t errors = 0;
+    size_t delivered = deeplayer::decode_batch(paths, options, [&](BatchItem& item) {
+      if (item.index == 3) {
+        EXPECT(item.error == direct_error, "cache=%d: missing file: %s", use_cache,
+               item.error.c_str());
+      } else if (item.index == 4) {
+        EXPECT(item.error.find("Unsupported audio format") == 0,
+               "cache=%d: garbage file: %s", use_cache, item.error.c_str());
+      } else {
+        EXPECT(item.error.empty(), "cache=%d: file %zu: %s", use_cache, item.index,
+               item.error.c_str());
+      }
+      if (!item.error.empty()) {
+        errors++;
+        EXPECT(item.pcm.empty(), "failed item carries samples");
+      }
+      return true;
+    });
+    EXPECT(delivered == paths.size() && errors == 2, "cache=%d: %zu delivered, %zu errors",
+           use_cache, delivered, errors);
+  }
+}
+
+void test_cancel() {
+  Library library(12);
+  for (int threads : {1, 4}) {
+    BatchOptions options;
+    options.num_threads = threads;
+    size_t calls = 0;
+    size_t delivered = deeplayer::decode_batch(library.paths, options, [&](BatchItem&) {
+      return ++calls < 3;
+    });
+    EXPECT(delivered == 3 && calls == 3, "threads=%d: %zu delivered after cancel", threads,
+           delivered);
+  }
+
+  // A throwing callback cancels the batch and the exception reaches the caller.
+  BatchOptions options;
+  options.num_threads = 4;
+  size_t calls = 0;
+  bool threw = false;
+  try {
+    deeplayer::decode_batch(library.paths, options, [&](BatchItem&) -> bool {
+      calls++;
+      throw std::runtime_error("stop");
+    });
+  } catch (const std::runtime_error& e) {
+    threw = std::string(e.what()) == "stop";
+  }
+  EXPECT(threw && calls == 1, "callback exception: threw=%d calls=%zu", threw, calls);
+}
+
+void test_budget_smaller_than_files() {
+  // Every file is larger than the budget, so each one is decoded alone; the
+  // batch must still finish with the right results.
+  Library library(6);
+  BatchOptions options;
+  options.num_threads = 4;
+  options.max_buffered_bytes = 1024;
+  size_t delivered = deeplayer::decode_batch(library.paths, options, [&](BatchItem& item) {
+    EXPECT(item.error.empty() &&
+               item.pcm.size() == library.expected_samples[item.index],
+           "file %zu: %zu samples, error '%s'", item.index, item.pcm.size(),
+           item.error.c_str());
+    return true;
+  });
+  EXPECT(delivered == library.paths.size(), "delivered %zu", delivered);
+}
+
+void test_decode_limit() {
+  Library library(2);
+  deeplayer::AudioDecoder decoder;
+  size_t samples = library.expected_samples[1];
+  EXPECT(decoder.decode(library.paths[1], samples).data.size() == samples,
+         "limit equal to the output size");
+  bool threw = false;
+  try {
+    decoder.decode(library.paths[1], samples - 1);
+  } catch (const deeplayer::DecodeLimitError&) {
+    threw = true;
+  }
+  EXPECT(threw, "no DecodeLimitError one sample under the output size");
+}
+
+}  // namespace
+
+int main() {
+  test_decodes_every_file();
+  test_failures_are_per_file();
+  test_cancel();
+  test_budget_smaller_than_files();
+  test_decode_limit();
+  return native_test::finish("batch_decoder_test");
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+// Host stand-in for the NDK logging header, so the decoder sources build
+// without the NDK. Messages are dropped.
+
+enum { ANDROID_LOG_INFO = 4, ANDROID_LOG_WARN = 5, ANDROID_LOG_ERROR = 6 };
+
+inline int __android_log_print(int /* prio */, const char* /* tag */,
+                               const char* /* fmt */, ...) {
+  return 0;
+}
@@ -0,0 +1,167 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "feature_codec.h"
+#include "mel_spectrogram.h"
+#include "native_test.h"
+
+namespace {
+
+using deeplayer::MelSpectrogram;
+
+constexpr int kBands = MelSpectrogram::kNumMelBands;
+
+/** Numeric fields of src/test/resources/mel_440hz_ground_truth.json. */
+struct Fixture {
+  double frequency_hz;
+  int sample_rate;
+  double duration_seconds;
+  int expected_num_frames;
+  int peak_band_min;
+  int peak_band_max;
+  double tolerance_absolute;
+};
+
+/** Value of the first "key": number in json; the fixture has no duplicate keys. */
+double json_number(const std::string& json, const std::string& key) {
+  size_t pos = json.find("\"" + key + "\"");
+  if (pos == std::string::npos) {
+    std::fprintf(stderr, "fixture has no %s\n", key.c_str());
+    std::exit(1);
+  }
+  pos = json.find(':', pos);
+  return std::strtod(json.c_str() + pos + 1, nullptr);
+}
+
+Fixture load_fixture() {
+  std::ifstream file(MEL_FIXTURE_PATH);
+  if (!file) {
+    std::fprintf(stderr, "cannot open %s\n", MEL_FIXTURE_PATH);
+    std::exit(1);
+  }
+  std::stringstream buffer;
+  buffer << file.rdbuf();
+  const std::string json = buffer.str();
+  Fixture f;
+  f.frequency_hz = json_number(json, "frequency_hz");
+  f.sample_rate = static_cast<int>(json_number(json, "sample_rate"));
+  f.duration_seconds = json_number(json, "duration_seconds");
+  f.expected_num_frames = static_cast<int>(json_number(json, "expected_num_frames"));
+  f.peak_band_min = static_cast<int>(json_number(json, "peak_mel_band_min"));
+  f.peak_band_max = static_cast<int>(json_number(json, "peak_mel_band_max"));
+  f.tolerance_absolute = json_number(json, "tolerance_absolute");
+  return f;
+}
+
+std::vector<float> sine(const Fixture& f) {
+  std::vector<float> pcm(static_cast<size_t>(f.sample_rate * f.duration_seconds));
+  for (size_t i = 0; i < pcm.size(); i++) {
+    double phase = 2.0 * M_PI * f.frequency_hz * i / f.sample_rate;
+    pcm[i] = static_cast<float>(0.5 * std::sin(phase));
+  }
+  return pcm;
+}
+
+/** Check the fixture's frame count and peak band on a decoded matrix. */
+void check_peaks(const Fixture& f, const std::vector<float>& mel, const char* what) {
+  int frames = static_cast<int>(mel.size() / kBands);
+  EXPECT(frames == f.expected_num_frames, "%s: %d frames", what, frames);
+  for (int t = 0; t < frames; t++) {
+    const float* row = mel.data() + t * kBands;
+    int peak = static_cast<int>(std::max_element(row, row + kBands) - row);
+    if (peak < f.peak_band_min || peak > f.peak_band_max) {
+      EXPECT(false, "%s: frame %d peaks in band %d", what, t, peak);
+      return;
+    }
+  }
+}
+
+void test_float(const Fixture& f, const std::vector<float>& pcm,
+                const std::vector<float>& reference) {
+  EXPECT(MelSpectrogram::num_frames(pcm.size()) == f.expected_num_frames,
+         "num_frames %d", MelSpectrogram::num_frames(pcm.size()));
+  check_peaks(f, reference, "float32");
+}
+
+// FLOAT16 must stay within the fixture's absolute tolerance of float32.
+void test_half(const Fixture& f, MelSpectrogram& mel, const std::vector<float>& pcm,
+               const std::vector<float>& reference) {
+  std::vector<uint16_t> half = mel.compute_half(pcm);
+  EXPECT(half.size() == reference.size(), "%zu values vs %zu", half.size(),
+         reference.size());
+  if (half.size() != reference.size()) return;
+  std::vector<float> decoded(half.size());
+  deeplayer::half_to_float(half.data(), half.size(), decoded.data());
+
+  double max_error = 0.0;
+  for (size_t i = 0; i < decoded.size(); i++) {
+    double error = std::fabs(static_cast<double>(decoded[i]) - reference[i]);
+    max_error = std::max(max_error, error);
+  }
+  EXPECT(max_error <= f.tolerance_absolute, "float16: max error %.5f", max_error);
+  check_peaks(f, decoded, "float16");
+}
+
+// INT8 must decode (offset + code * scale, as FrameMatrix.Int8 does) to within
+// half a step of float32 in every frame.
+void test_u8(const Fixture& f, MelSpectrogram& mel, const std::vector<float>& pcm,
+             const std::vector<float>& reference) {
+  std::vector<float> scales;
+  std::vector<float> offsets;
+  std::vector<uint8_t> codes = mel.compute_u8(pcm, &scales, &offsets);
+  size_t frames = reference.size() / kBands;
+  EXPECT(codes.size() == reference.size() && scales.size() == frames &&
+             offsets.size() == frames,
+         "%zu codes, %zu scales for %zu frames", codes.size(), scales.size(), frames);
+  if (codes.size() != reference.size() || scales.size() != frames) return;
+
+  std::vector<float> decoded(codes.size());
+  double worst = 0.0;
+  for (size_t t = 0; t < frames; t++) {
+    EXPECT(scales[t] > 0.0f && scales[t] <= deeplayer::kMaxInt8Range / 255.0f,
+           "frame %zu: scale %f", t, scales[t]);
+    for (int b = 0; b < kBands; b++) {
+      size_t i = t * kBands + b;
+      decoded[i] = offsets[t] + codes[i] * scales[t];
+      // The sine's log-mel range is well under kMaxInt8Range, so nothing clamps.
+      double error = std::fabs(static_cast<double>(decoded[i]) - reference[i]);
+      worst = std::max(worst, error / scales[t]);
+    }
+  }
+  EXPECT(worst <= 0.5 + 1e-3, "int8: max error %.4f steps", worst);
+  check_peaks(f, decoded, "int8");
+}
+
+void test_short_input() {
+  MelSpectrogram mel;
+  std::vector<float> pcm(MelSpectrogram::kWindowSize - 1, 0.1f);
+  std::vector<float> scales;
+  std::vector<float> offsets;
+  EXPECT(MelSpectrogram::num_frames(pcm.size()) == 0, "frames for a partial window");
+  EXPECT(mel.compute(pcm).empty() && mel.compute_half(pcm).empty() &&
+             mel.compute_u8(pcm, &scales, &offsets).empty() && scales.empty(),
+         "output for a partial window");
+  pcm.push_back(0.1f);
+  EXPECT(mel.compute_half(pcm).size() == kBands, "one full window");
+}
+
+}  // namespace
+
+int main() {
+  const Fixture fixture = load_fixture();
+  const std::vector<float> pcm = sine(fixture);
+  MelSpectrogram mel;
+  const std::vector<float> reference = mel.compute(pcm);
+
+  test_float(fixture, pcm, reference);
+  test_half(fixture, mel, pcm, reference);
+  test_u8(fixture, mel, pcm, reference);
+  test_short_input();
+  return native_test::finish("mel_spectrogram_test");
+}
@@ -0,0 +1,142 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <limits>
+#include <thread>
+
+#include "memory_budget.h"
+#include "native_test.h"
+
+namespace {
+
+using deeplayer::MemoryBudget;
+
+/** Long enough for a thread that is not blocked to get through acquire. */
+void settle() { std::this_thread::sleep_for(std::chrono::milliseconds(50)); }
+
+/** Runs acquire(bytes) on its own thread and records the outcome. */
+class Waiter {
+ public:
+  Waiter(MemoryBudget& budget, size_t bytes)
+      : thread_([this, &budget, bytes] {
+          result_ = budget.acquire(bytes);
+          done_ = true;
+        }) {}
+  ~Waiter() {
+    if (thread_.joinable()) thread_.join();
+  }
+
+  bool done() const { return done_; }
+  bool result() const { return result_; }
+  void join() { thread_.join(); }
+
+ private:
+  std::atomic<bool> done_{false};
+  std::atomic<bool> result_{false};
+  std::thread thread_;
+};
+
+void test_waits_for_room() {
+  MemoryBudget budget(100);
+  EXPECT(budget.acquire(50), "first reservation");
+  EXPECT(budget.acquire(50), "exactly up to the limit");
+  {
+    Waiter waiter(budget, 1);
+    settle();
+    EXPECT(!waiter.done(), "acquired past the limit");
+    budget.release(50);
+    settle();
+    EXPECT(waiter.done() && waiter.result(), "not woken by release");
+  }
+  budget.release(51);
+}
+
+void test_adjust_down_wakes() {
+  MemoryBudget budget(100);
+  EXPECT(budget.acquire(90), "reservation");
+  Waiter waiter(budget, 50);
+  settle();
+  EXPECT(!waiter.done(), "acquired past the limit");
+  budget.adjust(90, 40);
+  settle();
+  EXPECT(waiter.done() && waiter.result(), "not woken by a smaller actual size");
+}
+
+void test_oversized_runs_alone() {
+  MemoryBudget budget(100);
+  EXPECT(budget.acquire(10), "small reservation");
+  {
+    Waiter big(budget, 500);
+    settle();
+    EXPECT(!big.done(), "oversized request ran alongside another holder");
+    budget.release(10);
+    settle();
+    EXPECT(big.done() && big.result(), "oversized request never ran");
+  }
+  Waiter small(budget, 1);
+  settle();
+  EXPECT(!small.done(), "small request ran alongside an oversized one");
+  budget.release(500);
+  settle();
+  EXPECT(small.done(), "small request not woken");
+}
+
+void test_exclusive_is_not_starved() {
+  MemoryBudget budget(100);
+  EXPECT(budget.acquire(30), "small reservation");
+  Waiter exclusive(budget, 100);
+  settle();
+  // There is room for 10 more, but the whole-budget request queued first.
+  Waiter small(budget, 10);
+  settle();
+  EXPECT(!exclusive.done() && !small.done(), "someone acquired while 30 was held");
+  budget.release(30);
+  settle();
+  EXPECT(exclusive.done(), "whole-budget request did not run once drained");
+  EXPECT(!small.done(), "small request ran alongside the whole-budget one");
+  budget.release(100);
+  settle();
+  EXPECT(small.done(), "small request not woken");
+}
+
+void test_growth_beyond_size_max_does_not_wrap() {
+  // A holder running alone may grow far past the limit; used + bytes must not
+  // wrap around and let a small request through.
+  const size_t huge = std::numeric_limits<size_t>::max() - 5;
+  MemoryBudget budget(100);
+  EXPECT(budget.acquire(100), "whole budget");
+  budget.adjust(100, huge);
+  Waiter small(budget, 10);
+  settle();
+  EXPECT(!small.done(), "acquired while the budget was overdrawn");
+  budget.release(huge);
+  settle();
+  EXPECT(small.done() && small.result(), "not woken after release");
+}
+
+void test_cancel() {
+  MemoryBudget budget(100);
+  EXPECT(budget.acquire(100), "whole budget");
+  Waiter small(budget, 10);
+  Waiter big(budget, 1000);
+  settle();
+  budget.cancel();
+  small.join();
+  big.join();
+  EXPECT(small.done() && !small.result(), "small waiter not failed by cancel");
+  EXPECT(big.done() && !big.result(), "big waiter not failed by cancel");
+  budget.release(100);
+  EXPECT(!budget.acquire(1), "acquire succeeded after cancel");
+}
+
+}  // namespace
+
+int main() {
+  test_waits_for_room();
+  test_adjust_down_wakes();
+  test_oversized_runs_alone();
+  test_exclusive_is_not_starved();
+  test_growth_beyond_size_max_does_not_wrap();
+  test_cancel();
+  return native_test::finish("memory_budget_test");
+}
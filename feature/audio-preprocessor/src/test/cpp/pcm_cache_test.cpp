@@ -0,0 +1,196 @@
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "audio_decoder.h"
+#include "batch_decoder.h"
+#include "native_test.h"
+#include "pcm_cache.h"
+#include "test_files.h"
+
+namespace {
+
+using deeplayer::BatchItem;
+using deeplayer::BatchOptions;
+using deeplayer::PcmCache;
+using test_files::TempDir;
+
+/** Set the modification time of path, in whole seconds. */
+void set_mtime(const std::string& path, time_t seconds) {
+  struct timespec times[2] = {{seconds, 0}, {seconds, 0}};
+  utimensat(AT_FDCWD, path.c_str(), times, 0);
+}
+
+void test_content_key() {
+  TempDir dir;
+  std::vector<uint8_t> a = test_files::make_wav(1000, 16000, 1, 1);
+  std::vector<uint8_t> b = test_files::make_wav(1000, 16000, 1, 2);
+  test_files::write_file(dir.file("a.wav"), a);
+  test_files::write_file(dir.file("a_copy.wav"), a);
+  test_files::write_file(dir.file("b.wav"), b);
+
+  std::string key = PcmCache::content_key(dir.file("a.wav"));
+  EXPECT(key.size() == 16 && key.find_first_not_of("0123456789abcdef") == std::string::npos,
+         "key '%s'", key.c_str());
+  EXPECT(PcmCache::content_key(dir.file("a_copy.wav")) == key, "copies differ");
+  EXPECT(PcmCache::content_key(dir.file("b.wav")) != key, "different files share a key");
+  EXPECT(PcmCache::content_key(dir.file("missing.wav")).empty(), "missing file");
+
+  // Reference xxHash64 values. The long input spans several read chunks and
+  // ends mid-stripe.
+  test_files::write_file(dir.file("abc"), {'a', 'b', 'c'});
+  EXPECT(PcmCache::content_key(dir.file("abc")) == "44bc2cf5ad770999", "'abc': %s",
+         PcmCache::content_key(dir.file("abc")).c_str());
+  std::vector<uint8_t> noise(3 * 1024 * 1024 + 37);
+  uint32_t state = 1;
+  for (uint8_t& byte : noise) {
+    state = state * 1664525u + 1013904223u;
+    byte = static_cast<uint8_t>(state >> 24);
+  }
+  test_files::write_file(dir.file("noise"), noise);
+  EXPECT(PcmCache::content_key(dir.file("noise")) == "2265e1d3ec356d4a", "noise: %s",
+         PcmCache::content_key(dir.file("noise")).c_str());
+}
+
+void test_store_and_load() {
+  TempDir dir;
+  PcmCache cache(dir.path());
+  std::vector<float> pcm = {0.0f, 0.5f, -1.0f, 0.25f};
+  const std::string key = "0123456789abcdef";
+  EXPECT(!cache.contains(key), "empty cache contains key");
+  cache.store(key, pcm, 16000);
+  EXPECT(cache.contains(key), "stored key missing");
+
+  std::vector<float> loaded;
+  EXPECT(cache.load(key, &loaded) && loaded == pcm, "round trip");
+  EXPECT(!cache.load("fedcba9876543210", &loaded), "missing key loaded");
+
+  // A truncated entry is rejected rather than read short.
+  truncate(cache.path_for(key).c_str(), 30);
+  EXPECT(!cache.load(key, &loaded), "truncated entry loaded");
+}
+
+void test_stamp_index() {
+  TempDir dir;
+  PcmCache cache(dir.path());
+  std::string path = dir.file("a.wav");
+  test_files::write_file(path, test_files::make_wav(1000, 16000, 1, 1));
+  set_mtime(path, 1000000000);
+
+  EXPECT(PcmCache::file_stamp(dir.file("missing.wav")).empty(), "missing file stamped");
+  std::string stamp = PcmCache::file_stamp(path);
+  EXPECT(!stamp.empty(), "no stamp");
+  EXPECT(cache.lookup(stamp).empty(), "lookup before remember");
+
+  const std::string key = "0123456789abcdef";
+  cache.remember(stamp, key);
+  EXPECT(cache.lookup(stamp) == key, "lookup after remember: '%s'",
+         cache.lookup(stamp).c_str());
+
+  // Touching the file changes its stamp.
+  set_mtime(path, 1000000001);
+  std::string touched = PcmCache::file_stamp(path);
+  EXPECT(touched != stamp, "stamp ignores mtime");
+  EXPECT(cache.lookup(touched).empty(), "lookup of a touched file");
+
+  // As does growing it, even with the old mtime restored.
+  test_files::write_file(path, test_files::make_wav(1001, 16000, 1, 1));
+  set_mtime(path, 1000000000);
+  EXPECT(PcmCache::file_stamp(path) != stamp, "stamp ignores size");
+
+  // A different path with the same size and mtime is a different file.
+  std::string other = dir.file("b.wav");
+  test_files::write_file(other, test_files::make_wav(1000, 16000, 1, 1));
+  set_mtime(other, 1000000000);
+  EXPECT(cache.lookup(PcmCache::file_stamp(other)).empty(), "stamp ignores path");
+}
+
+size_t run_batch(const std::vector<std::string>& paths, const std::string& cache_dir,
+                 std::vector<BatchItem>* items) {
+  BatchOptions options;
+  options.num_threads = 3;
+  options.cache_dir = cache_dir;
+  items->assign(paths.size(), BatchItem{});
+  return deeplayer::decode_batch(paths, options, [&](BatchItem& item) {
+    EXPECT(item.error.empty(), "file %zu: %s", item.index, item.error.c_str());
+    EXPECT(item.pcm.empty(), "samples delivered in cache mode");
+    (*items)[item.index] = std::move(item);
+    return true;
+  });
+}
+
+void test_batch_cache() {
+  TempDir library;
+  TempDir cache_dir;
+  PcmCache cache(cache_dir.path());
+  std::vector<std::string> paths;
+  for (int i = 0; i < 5; i++) {
+    paths.push_back(library.file("track" + std::to_string(i) + ".wav"));
+    test_files::write_file(paths.back(),
+                           test_files::make_wav(2000 + 500 * i, i % 2 ? 44100 : 16000, 1, i));
+    set_mtime(paths.back(), 1000000000);
+  }
+
+  // First scan decodes everything into the cache.
+  std::vector<BatchItem> first;
+  EXPECT(run_batch(paths, cache_dir.path(), &first) == paths.size(), "first scan");
+  deeplayer::AudioDecoder decoder;
+  for (size_t i = 0; i < paths.size(); i++) {
+    EXPECT(!first[i].cache_hit, "file %zu hit an empty cache", i);
+    EXPECT(first[i].cache_key == PcmCache::content_key(paths[i]), "file %zu key", i);
+    std::vector<float> cached;
+    EXPECT(cache.load(first[i].cache_key, &cached) &&
+               cached == decoder.decode(paths[i]).data,
+           "file %zu: cached samples differ from a direct decode", i);
+  }
+
+  // Second scan finds everything by stamp.
+  std::vector<BatchItem> second;
+  run_batch(paths, cache_dir.path(), &second);
+  for (size_t i = 0; i < paths.size(); i++) {
+    EXPECT(second[i].cache_hit && second[i].cache_key == first[i].cache_key,
+           "file %zu: hit=%d", i, second[i].cache_hit);
+  }
+
+  // An unchanged stamp is trusted without reading the file: rewrite track 0
+  // in place at the same size and mtime, and the old key comes back.
+  std::vector<uint8_t> same_size = test_files::make_wav(2000, 16000, 1, 9);
+  test_files::write_file(paths[0], same_size);
+  set_mtime(paths[0], 1000000000);
+  EXPECT(PcmCache::content_key(paths[0]) != first[0].cache_key, "rewrite kept the content");
+
+  // Track 1 is edited properly (new mtime): it is hashed and decoded again.
+  test_files::write_file(paths[1], test_files::make_wav(3000, 16000, 1, 7));
+  set_mtime(paths[1], 1000000500);
+
+  // A copy of track 2 under a new name hashes to the existing entry.
+  std::string copy = library.file("copy_of_track2.wav");
+  test_files::write_file(copy, test_files::make_wav(3000, 16000, 1, 2));
+  std::vector<std::string> rescan = paths;
+  rescan.push_back(copy);
+
+  std::vector<BatchItem> third;
+  run_batch(rescan, cache_dir.path(), &third);
+  EXPECT(third[0].cache_hit && third[0].cache_key == first[0].cache_key,
+         "unchanged stamp was rehashed");
+  EXPECT(!third[1].cache_hit && third[1].cache_key != first[1].cache_key &&
+             third[1].cache_key == PcmCache::content_key(paths[1]),
+         "edited file: hit=%d", third[1].cache_hit);
+  EXPECT(third[5].cache_hit && third[5].cache_key == first[2].cache_key,
+         "copy: hit=%d", third[5].cache_hit);
+  EXPECT(cache.lookup(PcmCache::file_stamp(copy)) == first[2].cache_key,
+         "copy's stamp not recorded");
+}
+
+}  // namespace
+
+int main() {
+  test_content_key();
+  test_store_and_load();
+  test_stamp_index();
+  test_batch_cache();
+  return native_test::finish("pcm_cache_test");
+}
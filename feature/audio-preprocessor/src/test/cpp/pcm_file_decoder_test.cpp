@@ -0,0 +1,455 @@
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "native_test.h"
+#include "pcm_file_decoder.h"
+#include "sinc_resampler.h"
+
+namespace {
+
+using deeplayer::PcmFileInfo;
+using deeplayer::SampleFormat;
+using Bytes = std::vector<uint8_t>;
+
+void put_tag(Bytes* b, const char* tag) { b->insert(b->end(), tag, tag + 4); }
+
+void put_le(Bytes* b, uint64_t v, int n) {
+  for (int k = 0; k < n; k++) b->push_back(static_cast<uint8_t>(v >> (8 * k)));
+}
+
+void put_be(Bytes* b, uint64_t v, int n) {
+  for (int k = n - 1; k >= 0; k--) b->push_back(static_cast<uint8_t>(v >> (8 * k)));
+}
+
+/** 80-bit extended encoding of a positive integer sample rate. */
+void put_extended(Bytes* b, uint32_t rate) {
+  int shift = 31;
+  while (!(rate >> shift)) shift--;
+  put_be(b, 16383 + shift, 2);
+  put_be(b, static_cast<uint64_t>(rate) << (63 - shift), 8);
+}
+
+void patch_le32(Bytes* b, size_t pos, uint32_t v) {
+  for (int k = 0; k < 4; k++) (*b)[pos + k] = static_cast<uint8_t>(v >> (8 * k));
+}
+
+struct WavSpec {
+  uint16_t format_tag = 1;
+  uint16_t channels = 2;
+  uint32_t rate = 44100;
+  uint16_t bits = 16;
+  int block_align = -1;  // -1: derive from channels and bits
+  uint32_t fmt_size = 16;
+  bool extensible = false;
+  uint16_t sub_format = 1;
+  /** Optional chunk written before "fmt " (odd sizes test the pad byte). */
+  const char* extra_tag = nullptr;
+  uint32_t extra_size = 0;
+  bool pad_extra = true;
+  size_t frames = 10;
+  int64_t data_size = -1;  // -1: the real size
+};
+
+Bytes make_wav(const WavSpec& spec) {
+  Bytes b;
+  put_tag(&b, "RIFF");
+  put_le(&b, 0, 4);
+  put_tag(&b, "WAVE");
+  if (spec.extra_tag) {
+    put_tag(&b, spec.extra_tag);
+    put_le(&b, spec.extra_size, 4);
+    b.insert(b.end(), spec.extra_size, 0xAB);
+    if (spec.pad_extra && (spec.extra_size & 1)) b.push_back(0);
+  }
+  uint32_t fmt_size = spec.extensible ? 40 : spec.fmt_size;
+  int block_align = spec.block_align >= 0 ? spec.block_align : spec.channels * spec.bits / 8;
+  put_tag(&b, "fmt ");
+  put_le(&b, fmt_size, 4);
+  size_t fmt_start = b.size();
+  put_le(&b, spec.extensible ? 0xFFFE : spec.format_tag, 2);
+  put_le(&b, spec.channels, 2);
+  put_le(&b, spec.rate, 4);
+  put_le(&b, spec.rate * block_align, 4);
+  put_le(&b, block_align, 2);
+  put_le(&b, spec.bits, 2);
+  if (spec.extensible) {
+    put_le(&b, 22, 2);           // cbSize
+    put_le(&b, spec.bits, 2);    // valid bits
+    put_le(&b, 3, 4);            // channel mask
+    put_le(&b, spec.sub_format, 2);
+    b.insert(b.end(), 14, 0x11);  // rest of the GUID
+  }
+  while (b.size() < fmt_start + fmt_size) b.push_back(0);
+
+  size_t data_bytes = spec.frames * block_align;
+  put_tag(&b, "data");
+  put_le(&b, spec.data_size >= 0 ? static_cast<uint64_t>(spec.data_size) : data_bytes, 4);
+  for (size_t i = 0; i < data_bytes; i++) b.push_back(static_cast<uint8_t>(i * 7));
+  patch_le32(&b, 4, static_cast<uint32_t>(b.size() - 8));
+  return b;
+}
+
+struct AiffSpec {
+  bool aifc = false;
+  const char* compression = "NONE";
+  uint16_t channels = 2;
+  uint32_t num_frames = 10;
+  uint16_t bits = 16;
+  uint32_t rate = 44100;
+  uint32_t ssnd_offset = 0;
+  size_t frames = 10;
+  /** Optional odd-size chunk written before "COMM". */
+  bool odd_chunk = false;
+  bool have_ssnd = true;
+};
+
+Bytes make_aiff(const AiffSpec& spec) {
+  Bytes b;
+  put_tag(&b, "FORM");
+  put_be(&b, 0, 4);
+  put_tag(&b, spec.aifc ? "AIFC" : "AIFF");
+  if (spec.odd_chunk) {
+    put_tag(&b, "NAME");
+    put_be(&b, 5, 4);
+    b.insert(b.end(), {'h', 'e', 'l', 'l', 'o', 0});
+  }
+  put_tag(&b, "COMM");
+  put_be(&b, spec.aifc ? 24 : 18, 4);
+  put_be(&b, spec.channels, 2);
+  put_be(&b, spec.num_frames, 4);
+  put_be(&b, spec.bits, 2);
+  put_extended(&b, spec.rate);
+  if (spec.aifc) {
+    put_tag(&b, spec.compression);
+    b.insert(b.end(), {0, 0});  // empty pascal string, padded
+  }
+  if (spec.have_ssnd) {
+    size_t frame_bytes = spec.channels * ((spec.bits + 7) / 8);
+    if (!std::strcmp(spec.compression, "fl32")) frame_bytes = spec.channels * 4;
+    size_t data_bytes = spec.frames * frame_bytes;
+    put_tag(&b, "SSND");
+    put_be(&b, 8 + spec.ssnd_offset + data_bytes, 4);
+    put_be(&b, spec.ssnd_offset, 4);
+    put_be(&b, 0, 4);
+    b.insert(b.end(), spec.ssnd_offset, 0xEE);
+    for (size_t i = 0; i < data_bytes; i++) b.push_back(static_cast<uint8_t>(i * 5));
+  }
+  size_t form_size = b.size() - 8;
+  for (int k = 0; k < 4; k++) b[4 + k] = static_cast<uint8_t>(form_size >> (24 - 8 * k));
+  return b;
+}
+
+bool parse(const Bytes& b, PcmFileInfo* info) {
+  return deeplayer::parse_pcm_header(b.data(), b.size(), info);
+}
+
+void test_wav_basic() {
+  Bytes wav = make_wav({});
+  PcmFileInfo info;
+  EXPECT(parse(wav, &info), "plain 16-bit stereo");
+  EXPECT(info.layout.format == SampleFormat::kS16, "format");
+  EXPECT(info.layout.channels == 2 && !info.layout.big_endian, "layout");
+  EXPECT(info.sample_rate == 44100, "rate %d", info.sample_rate);
+  EXPECT(info.data_offset == 44, "data offset %zu", info.data_offset);
+  EXPECT(info.frames == 10, "frames %zu", info.frames);
+
+  WavSpec f32;
+  f32.format_tag = 3;
+  f32.bits = 32;
+  EXPECT(parse(make_wav(f32), &info) && info.layout.format == SampleFormat::kF32,
+         "IEEE float");
+
+  WavSpec ext;
+  ext.extensible = true;
+  ext.bits = 24;
+  EXPECT(parse(make_wav(ext), &info) && info.layout.format == SampleFormat::kS24,
+         "extensible PCM");
+  ext.sub_format = 3;
+  ext.bits = 64;
+  EXPECT(parse(make_wav(ext), &info) && info.layout.format == SampleFormat::kF64,
+         "extensible float");
+
+  WavSpec u8;
+  u8.bits = 8;
+  u8.channels = 1;
+  EXPECT(parse(make_wav(u8), &info) && info.layout.format == SampleFormat::kU8 &&
+             info.frames == 10,
+         "8-bit mono");
+}
+
+void test_wav_odd_chunk() {
+  // A 3-byte chunk is followed by one pad byte before "fmt ".
+  WavSpec spec;
+  spec.extra_tag = "LIST";
+  spec.extra_size = 3;
+  PcmFileInfo info;
+  EXPECT(parse(make_wav(spec), &info) && info.data_offset == 56 && info.frames == 10,
+         "odd chunk with padding: offset %zu", info.data_offset);
+
+  // Without the pad byte, the next chunk header is misread.
+  spec.pad_extra = false;
+  EXPECT(!parse(make_wav(spec), &info), "odd chunk without padding parsed");
+
+  spec.extra_size = 4;
+  spec.pad_extra = true;
+  EXPECT(parse(make_wav(spec), &info) && info.data_offset == 56, "even chunk");
+}
+
+void test_wav_malformed() {
+  PcmFileInfo info;
+  auto rejects = [&](WavSpec spec, const char* what) {
+    EXPECT(!parse(make_wav(spec), &info), "accepted %s", what);
+  };
+  WavSpec spec;
+  spec.format_tag = 2;
+  rejects(spec, "ADPCM");
+  spec = {};
+  spec.bits = 12;
+  spec.block_align = 4;
+  rejects(spec, "12-bit PCM");
+  spec = {};
+  spec.format_tag = 3;
+  rejects(spec, "16-bit float");
+  spec = {};
+  spec.block_align = 3;
+  rejects(spec, "block_align mismatch");
+  spec = {};
+  spec.channels = 0;
+  rejects(spec, "zero channels");
+  spec = {};
+  spec.channels = 65;
+  rejects(spec, "65 channels");
+  spec = {};
+  spec.rate = 0;
+  rejects(spec, "zero rate");
+  spec = {};
+  spec.rate = 1000000;
+  rejects(spec, "1 MHz rate");
+  spec = {};
+  spec.fmt_size = 14;
+  rejects(spec, "short fmt chunk");
+
+  // "data" before "fmt ".
+  Bytes b;
+  put_tag(&b, "RIFF");
+  put_le(&b, 12, 4);
+  put_tag(&b, "WAVE");
+  put_tag(&b, "data");
+  put_le(&b, 0, 4);
+  EXPECT(!parse(b, &info), "data before fmt");
+
+  // fmt chunk claims to run past the end of the file.
+  Bytes wav = make_wav({});
+  patch_le32(&wav, 16, 1000);
+  EXPECT(!parse(wav, &info), "oversized fmt chunk");
+
+  Bytes not_wave = make_wav({});
+  std::memcpy(not_wave.data() + 8, "AVI ", 4);
+  EXPECT(!parse(not_wave, &info), "RIFF/AVI");
+  EXPECT(!deeplayer::parse_pcm_header(wav.data(), 11, &info), "11 bytes");
+  Bytes garbage(256, 0x5A);
+  EXPECT(!parse(garbage, &info), "garbage");
+}
+
+void test_wav_truncated() {
+  Bytes wav = make_wav({});
+  for (size_t size = 0; size < wav.size(); size++) {
+    PcmFileInfo info;
+    bool ok = deeplayer::parse_pcm_header(wav.data(), size, &info);
+    if (size < 44) {
+      EXPECT(!ok, "header cut at %zu bytes parsed", size);
+    } else {
+      // The data chunk is cut short: only whole frames count.
+      EXPECT(ok && info.frames == (size - 44) / 4, "cut at %zu: ok=%d frames=%zu", size,
+             ok, ok ? info.frames : 0);
+    }
+  }
+}
+
+void test_wav_streaming_sizes() {
+  // Streaming writers leave the data size at 0 or 0xFFFFFFFF.
+  for (int64_t data_size : {int64_t{0}, int64_t{0xFFFFFFFF}}) {
+    WavSpec spec;
+    spec.data_size = data_size;
+    Bytes wav = make_wav(spec);
+    PcmFileInfo info;
+    bool ok = parse(wav, &info);
+    if (data_size == 0) {
+      EXPECT(ok && info.frames == 0, "size 0: frames %zu", ok ? info.frames : 0);
+    } else {
+      EXPECT(ok && info.frames == 10, "size 0xFFFFFFFF: frames %zu", ok ? info.frames : 0);
+    }
+  }
+}
+
+void test_aiff() {
+  PcmFileInfo info;
+  EXPECT(parse(make_aiff({}), &info), "plain AIFF");
+  EXPECT(info.layout.format == SampleFormat::kS16 && info.layout.big_endian &&
+             info.layout.channels == 2,
+         "AIFF layout");
+  EXPECT(info.sample_rate == 44100, "AIFF rate %d", info.sample_rate);
+  EXPECT(info.data_offset == 54, "AIFF data offset %zu", info.data_offset);
+  EXPECT(info.frames == 10, "AIFF frames %zu", info.frames);
+
+  AiffSpec odd;
+  odd.odd_chunk = true;
+  EXPECT(parse(make_aiff(odd), &info) && info.data_offset == 68 && info.frames == 10,
+         "AIFF odd chunk: offset %zu", info.data_offset);
+
+  AiffSpec offset;
+  offset.ssnd_offset = 6;
+  EXPECT(parse(make_aiff(offset), &info) && info.data_offset == 60 && info.frames == 10,
+         "SSND offset: offset %zu frames %zu", info.data_offset, info.frames);
+
+  // COMM frame count below the SSND contents wins.
+  AiffSpec fewer;
+  fewer.num_frames = 4;
+  EXPECT(parse(make_aiff(fewer), &info) && info.frames == 4, "num_frames cap");
+
+  AiffSpec bits12;
+  bits12.bits = 12;
+  EXPECT(parse(make_aiff(bits12), &info) && info.layout.format == SampleFormat::kS16,
+         "12-bit AIFF");
+
+  AiffSpec sowt;
+  sowt.aifc = true;
+  sowt.compression = "sowt";
+  EXPECT(parse(make_aiff(sowt), &info) && !info.layout.big_endian &&
+             info.layout.format == SampleFormat::kS16,
+         "AIFC sowt");
+
+  AiffSpec fl32;
+  fl32.aifc = true;
+  fl32.compression = "fl32";
+  fl32.bits = 32;
+  EXPECT(parse(make_aiff(fl32), &info) && info.layout.format == SampleFormat::kF32 &&
+             info.layout.big_endian && info.frames == 10,
+         "AIFC fl32");
+
+  AiffSpec ima4;
+  ima4.aifc = true;
+  ima4.compression = "ima4";
+  EXPECT(!parse(make_aiff(ima4), &info), "AIFC ima4 accepted");
+
+  AiffSpec bits0;
+  bits0.bits = 0;
+  EXPECT(!parse(make_aiff(bits0), &info), "0-bit AIFF accepted");
+
+  AiffSpec bits40;
+  bits40.bits = 40;
+  EXPECT(!parse(make_aiff(bits40), &info), "40-bit AIFF accepted");
+
+  AiffSpec no_ssnd;
+  no_ssnd.have_ssnd = false;
+  EXPECT(!parse(make_aiff(no_ssnd), &info), "AIFF without SSND accepted");
+
+  Bytes aiff = make_aiff({});
+  for (size_t size = 0; size < 46; size++) {
+    EXPECT(!deeplayer::parse_pcm_header(aiff.data(), size, &info),
+           "AIFF cut at %zu bytes parsed", size);
+  }
+  EXPECT(deeplayer::parse_pcm_header(aiff.data(), 54 + 4 * 3 + 2, &info) &&
+             info.frames == 3,
+         "truncated SSND: frames %zu", info.frames);
+}
+
+std::string write_temp(const Bytes& contents) {
+  char path[] = "/tmp/pcm_file_decoder_testXXXXXX";
+  int fd = mkstemp(path);
+  if (fd < 0) return "";
+  bool ok = write(fd, contents.data(), contents.size()) ==
+            static_cast<ssize_t>(contents.size());
+  close(fd);
+  return ok ? path : "";
+}
+
+/** Open path at 16 kHz and decode it. */
+bool decode_file(const std::string& path, std::vector<float>* out) {
+  deeplayer::PcmFile file;
+  if (!file.open(path, 16000)) return false;
+  file.decode(out);
+  return out->size() == file.output_size();
+}
+
+void test_decode_file() {
+  std::vector<float> out;
+  EXPECT(!decode_file("/nonexistent/file.wav", &out), "missing file");
+
+  // 16 kHz mono 16-bit passes through without resampling, in several blocks.
+  WavSpec mono;
+  mono.channels = 1;
+  mono.rate = 16000;
+  mono.frames = 10000;
+  Bytes wav = make_wav(mono);
+  std::string path = write_temp(wav);
+  EXPECT(!path.empty(), "could not write a temp file");
+  EXPECT(decode_file(path, &out) && out.size() == 10000, "16 kHz mono: %zu samples",
+         out.size());
+  for (size_t i = 0; i < out.size(); i++) {
+    int16_t v = static_cast<int16_t>(wav[44 + 2 * i] | wav[45 + 2 * i] << 8);
+    if (out[i] != v / 32768.0f) {
+      EXPECT(false, "sample %zu: %f vs %f", i, out[i], v / 32768.0f);
+      break;
+    }
+  }
+  unlink(path.c_str());
+
+  // 44.1 kHz stereo goes through the resampler in several blocks.
+  WavSpec stereo;
+  stereo.frames = 10000;
+  path = write_temp(make_wav(stereo));
+  size_t expected = deeplayer::SincResampler(44100, 16000).output_size(10000);
+  EXPECT(decode_file(path, &out) && out.size() == expected,
+         "44.1 kHz stereo: %zu vs %zu samples", out.size(), expected);
+  unlink(path.c_str());
+
+  // Not a PCM container: the caller falls back to FFmpeg.
+  path = write_temp(Bytes(1000, 0x42));
+  EXPECT(!decode_file(path, &out), "garbage file decoded");
+  unlink(path.c_str());
+}
+
+void test_truncated_after_open() {
+  // Another app truncates the file between open() and decode(): the decode
+  // fails with an error rather than reading past the end of the file.
+  for (uint32_t rate : {16000u, 44100u}) {
+    WavSpec spec;
+    spec.rate = rate;
+    spec.frames = 10000;
+    std::string path = write_temp(make_wav(spec));
+    deeplayer::PcmFile file;
+    EXPECT(file.open(path, 16000) && file.info().frames == 10000, "rate %u: open", rate);
+    EXPECT(truncate(path.c_str(), 44 + 4 * 5000) == 0, "truncate");
+    std::vector<float> out;
+    bool threw = false;
+    try {
+      file.decode(&out);
+    } catch (const std::runtime_error& e) {
+      threw = std::string(e.what()).find(path) != std::string::npos;
+    }
+    EXPECT(threw, "rate %u: decode of a truncated file did not fail", rate);
+    unlink(path.c_str());
+  }
+}
+
+}  // namespace
+
+int main() {
+  test_wav_basic();
+  test_wav_odd_chunk();
+  test_wav_malformed();
+  test_wav_truncated();
+  test_wav_streaming_sizes();
+  test_aiff();
+  test_decode_file();
+  test_truncated_after_open();
+  return native_test::finish("pcm_file_decoder_test");
+}
@@ -0,0 +1,188 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "native_test.h"
+#include "pcm_kernels.h"
+
+namespace {
+
+using deeplayer::PcmLayout;
+using deeplayer::SampleFormat;
+
+// Straightforward decode of one sample, written independently of the kernels.
+double reference_sample(const uint8_t* p, SampleFormat format, bool big_endian) {
+  size_t n = deeplayer::bytes_per_sample(format);
+  uint8_t b[8];
+  for (size_t k = 0; k < n; k++) b[k] = big_endian ? p[n - 1 - k] : p[k];
+  switch (format) {
+    case SampleFormat::kU8:
+      return (b[0] - 128) / 128.0;
+    case SampleFormat::kS8:
+      return static_cast<int8_t>(b[0]) / 128.0;
+    case SampleFormat::kS16:
+      return static_cast<int16_t>(b[0] | b[1] << 8) / 32768.0;
+    case SampleFormat::kS24: {
+      int32_t v = b[0] | b[1] << 8 | b[2] << 16;
+      if (v & 0x800000) v -= 0x1000000;
+      return v / 8388608.0;
+    }
+    case SampleFormat::kS32: {
+      int32_t v;
+      std::memcpy(&v, b, 4);
+      return v / 2147483648.0;
+    }
+    case SampleFormat::kF32: {
+      float v;
+      std::memcpy(&v, b, 4);
+      return v;
+    }
+    case SampleFormat::kF64: {
+      double v;
+      std::memcpy(&v, b, 8);
+      return v;
+    }
+  }
+  return 0.0;
+}
+
+const char* format_name(SampleFormat format) {
+  switch (format) {
+    case SampleFormat::kU8: return "u8";
+    case SampleFormat::kS8: return "s8";
+    case SampleFormat::kS16: return "s16";
+    case SampleFormat::kS24: return "s24";
+    case SampleFormat::kS32: return "s32";
+    case SampleFormat::kF32: return "f32";
+    case SampleFormat::kF64: return "f64";
+  }
+  return "?";
+}
+
+// Random sample bytes; float formats get values in [-1, 1] so sums stay exact
+// enough to compare.
+std::vector<uint8_t> random_frames(std::mt19937& rng, size_t frames,
+                                   const PcmLayout& layout) {
+  size_t sample_bytes = deeplayer::bytes_per_sample(layout.format);
+  std::vector<uint8_t> data(frames * layout.channels * sample_bytes);
+  std::uniform_int_distribution<int> byte(0, 255);
+  std::uniform_real_distribution<double> unit(-1.0, 1.0);
+  for (size_t off = 0; off < data.size(); off += sample_bytes) {
+    uint8_t b[8];
+    if (layout.format == SampleFormat::kF32) {
+      float v = static_cast<float>(unit(rng));
+      std::memcpy(b, &v, 4);
+    } else if (layout.format == SampleFormat::kF64) {
+      double v = unit(rng);
+      std::memcpy(b, &v, 8);
+    } else {
+      for (size_t k = 0; k < sample_bytes; k++) b[k] = static_cast<uint8_t>(byte(rng));
+    }
+    for (size_t k = 0; k < sample_bytes; k++) {
+      data[off + k] = layout.big_endian ? b[sample_bytes - 1 - k] : b[k];
+    }
+  }
+  return data;
+}
+
+// Every frame count up to 40 covers the empty input, inputs shorter than one
+// vector and every tail length after the vector loop; the source is placed
+// at each offset 0..7 so no load can rely on alignment.
+void check_layout(const PcmLayout& layout) {
+  std::mt19937 rng(1234);
+  size_t frame_bytes = deeplayer::bytes_per_sample(layout.format) * layout.channels;
+  for (size_t frames = 0; frames <= 40; frames++) {
+    std::vector<uint8_t> data = random_frames(rng, frames, layout);
+    for (size_t offset = 0; offset < 8; offset++) {
+      std::vector<uint8_t> buffer(offset + data.size() + 1);
+      std::memcpy(buffer.data() + offset, data.data(), data.size());
+      // One spare slot past the end must stay untouched.
+      std::vector<float> out(frames + 1, 12345.0f);
+      deeplayer::pcm_to_mono(buffer.data() + offset, frames, layout, out.data());
+
+      for (size_t i = 0; i < frames; i++) {
+        double sum = 0.0;
+        for (int ch = 0; ch < layout.channels; ch++) {
+          sum += reference_sample(data.data() + i * frame_bytes +
+                                      ch * deeplayer::bytes_per_sample(layout.format),
+                                  layout.format, layout.big_endian);
+        }
+        double expected = sum / layout.channels;
+        EXPECT(std::fabs(out[i] - expected) <= 1e-6,
+               "%s x%d %s frames=%zu offset=%zu i=%zu: %.9f vs %.9f",
+               format_name(layout.format), layout.channels,
+               layout.big_endian ? "BE" : "LE", frames, offset, i, out[i], expected);
+      }
+      EXPECT(out[frames] == 12345.0f, "%s x%d frames=%zu: wrote past the end",
+             format_name(layout.format), layout.channels, frames);
+    }
+  }
+}
+
+void test_layouts() {
+  for (SampleFormat format : {SampleFormat::kU8, SampleFormat::kS8, SampleFormat::kS16,
+                              SampleFormat::kS24, SampleFormat::kS32, SampleFormat::kF32,
+                              SampleFormat::kF64}) {
+    for (int channels : {1, 2, 3}) {
+      for (bool big_endian : {false, true}) {
+        check_layout({format, channels, big_endian});
+      }
+    }
+  }
+}
+
+void test_s16_extremes() {
+  // Full-scale samples on both channels must not overflow the vector sums.
+  const int16_t values[] = {-32768, 32767, -32768, -32768, 32767, 32767, 0, -1};
+  std::vector<uint8_t> data;
+  for (int repeat = 0; repeat < 4; repeat++) {
+    for (int16_t v : values) {
+      data.push_back(static_cast<uint8_t>(v & 0xFF));
+      data.push_back(static_cast<uint8_t>((v >> 8) & 0xFF));
+    }
+  }
+  size_t frames = data.size() / 4;
+  std::vector<float> out(frames);
+  deeplayer::pcm_to_mono(data.data(), frames, {SampleFormat::kS16, 2, false}, out.data());
+  for (size_t i = 0; i < frames; i++) {
+    int16_t l = values[(2 * i) % 8];
+    int16_t r = values[(2 * i + 1) % 8];
+    float expected = static_cast<float>((l + r) / 65536.0);
+    EXPECT(out[i] == expected, "frame %zu: %.9f vs %.9f", i, out[i], expected);
+  }
+}
+
+void test_dot_product_x4() {
+  std::mt19937 rng(99);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  for (int n : {4, 8, 12, 44, 100}) {
+    std::vector<float> a(4 * n), b(4 * n);
+    for (float& v : a) v = unit(rng);
+    for (float& v : b) v = unit(rng);
+    const float* pa[4];
+    const float* pb[4];
+    for (int j = 0; j < 4; j++) {
+      pa[j] = a.data() + j * n;
+      pb[j] = b.data() + (3 - j) * n;
+    }
+    float out[4];
+    deeplayer::dot_product_x4(pa, pb, n, out);
+    for (int j = 0; j < 4; j++) {
+      double expected = 0.0;
+      for (int k = 0; k < n; k++) expected += static_cast<double>(pa[j][k]) * pb[j][k];
+      EXPECT(std::fabs(out[j] - expected) <= 1e-5, "n=%d j=%d: %.7f vs %.7f", n, j,
+             out[j], expected);
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  test_layouts();
+  test_s16_extremes();
+  test_dot_product_x4();
+  return native_test::finish("pcm_kernels_test");
+}
@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "native_test.h"
+#include "sinc_resampler.h"
+
+namespace {
+
+using deeplayer::SincResampler;
+
+struct Ratio {
+  int src;
+  int dst;
+};
+
+const Ratio kRatios[] = {{44100, 16000}, {48000, 16000}, {22050, 16000},
+                         {8000, 16000},  {16000, 48000}, {16000, 16000}};
+
+std::vector<float> resample(const std::vector<float>& input, const Ratio& ratio) {
+  SincResampler resampler(ratio.src, ratio.dst);
+  std::vector<float> output;
+  resampler.process(input.data(), input.size(), &output);
+  resampler.flush(&output);
+  return output;
+}
+
+std::vector<float> sine(size_t n, double frequency, int rate, double amplitude) {
+  std::vector<float> samples(n);
+  for (size_t i = 0; i < n; i++) {
+    samples[i] = static_cast<float>(amplitude * std::sin(2.0 * M_PI * frequency * i / rate));
+  }
+  return samples;
+}
+
+void test_is_supported() {
+  EXPECT(SincResampler::is_supported(44100, 16000), "44100 -> 16000");
+  EXPECT(SincResampler::is_supported(16000, 16000), "identity");
+  EXPECT(!SincResampler::is_supported(0, 16000), "zero source rate");
+  EXPECT(!SincResampler::is_supported(44100, -1), "negative target rate");
+  // 16000 / gcd(44101, 16000) = 16000 phases.
+  EXPECT(!SincResampler::is_supported(44101, 16000), "too many phases");
+  bool threw = false;
+  try {
+    SincResampler resampler(44101, 16000);
+  } catch (const std::invalid_argument&) {
+    threw = true;
+  }
+  EXPECT(threw, "constructor accepted an unsupported ratio");
+}
+
+// The stream must come out exactly ceil(n * dst / src) samples long, matching
+// the size callers reserve.
+void test_length() {
+  for (const Ratio& ratio : kRatios) {
+    for (size_t n : {size_t{0}, size_t{1}, size_t{2}, size_t{7}, size_t{441},
+                     size_t{1000}, size_t{44103}}) {
+      SincResampler resampler(ratio.src, ratio.dst);
+      size_t expected = static_cast<size_t>(
+          (static_cast<uint64_t>(n) * ratio.dst + ratio.src - 1) / ratio.src);
+      EXPECT(resampler.output_size(n) == expected, "%d->%d n=%zu: output_size %zu vs %zu",
+             ratio.src, ratio.dst, n, resampler.output_size(n), expected);
+      size_t produced = resample(std::vector<float>(n, 0.25f), ratio).size();
+      EXPECT(produced == expected, "%d->%d n=%zu: produced %zu vs %zu", ratio.src,
+             ratio.dst, n, produced, expected);
+    }
+  }
+}
+
+// Output sample j sits at input time j * src / dst: a sine in the passband
+// (up to half the lower Nyquist frequency) must come out with the same
+// amplitude and no delay.
+void test_phase() {
+  for (const Ratio& ratio : kRatios) {
+    double nyquist = std::min(ratio.src, ratio.dst) / 2.0;
+    for (double frequency : {0.05 * nyquist, 0.25 * nyquist, 0.5 * nyquist}) {
+      std::vector<float> output = resample(sine(ratio.src, frequency, ratio.src, 0.5), ratio);
+      // Skip the filter's ramp at both ends of the one-second signal.
+      double max_error = 0.0;
+      for (size_t j = 64; j + 64 < output.size(); j++) {
+        double expected = 0.5 * std::sin(2.0 * M_PI * frequency * j / ratio.dst);
+        max_error = std::max(max_error, std::fabs(output[j] - expected));
+      }
+      EXPECT(max_error < 1e-3, "%d->%d %.0f Hz: max error %.5f", ratio.src, ratio.dst,
+             frequency, max_error);
+    }
+  }
+}
+
+void test_identity_is_exact() {
+  std::vector<float> input = sine(1001, 440.0, 16000, 0.9);
+  std::vector<float> output = resample(input, {16000, 16000});
+  EXPECT(output == input, "16000 -> 16000 changed the signal");
+}
+
+void test_stopband() {
+  // 12 kHz aliases to 4 kHz at 16 kHz; the filter must remove it.
+  std::vector<float> output = resample(sine(48000, 12000.0, 48000, 0.5), {48000, 16000});
+  double peak = 0.0;
+  for (size_t j = 64; j + 64 < output.size(); j++) {
+    peak = std::max(peak, static_cast<double>(std::fabs(output[j])));
+  }
+  EXPECT(peak < 5e-3, "12 kHz leaked through at %.5f", peak);
+}
+
+// Splitting the input into arbitrary blocks, through either process() or
+// input_buffer()/commit(), must give bit-identical output.
+void test_streaming_matches_one_shot() {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+  std::uniform_int_distribution<size_t> block(1, 700);
+  std::vector<float> input(20011);
+  for (float& v : input) v = unit(rng);
+
+  for (const Ratio& ratio : kRatios) {
+    std::vector<float> expected = resample(input, ratio);
+    for (bool direct : {false, true}) {
+      SincResampler resampler(ratio.src, ratio.dst);
+      std::vector<float> output;
+      for (size_t done = 0; done < input.size();) {
+        size_t n = std::min(block(rng), input.size() - done);
+        if (direct) {
+          float* dst = resampler.input_buffer(n);
+          std::copy(input.begin() + done, input.begin() + done + n, dst);
+          resampler.commit(n, &output);
+        } else {
+          resampler.process(input.data() + done, n, &output);
+        }
+        done += n;
+      }
+      resampler.flush(&output);
+      EXPECT(output == expected, "%d->%d %s: streamed output differs", ratio.src,
+             ratio.dst, direct ? "commit" : "process");
+    }
+  }
+}
+
+}  // namespace
+
+int main() {
+  test_is_supported();
+  test_length();
+  test_phase();
+  test_identity_is_exact();
+  test_stopband();
+  test_streaming_matches_one_shot();
+  return native_test::finish("sinc_resampler_test");
+}
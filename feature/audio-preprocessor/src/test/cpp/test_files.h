@@ -0,0 +1,84 @@
+#pragma once
+
+// Scratch files shared by the tests that go through the file system.
+
+#include <dirent.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace test_files {
+
+/** Directory under /tmp, removed with its files on destruction. */
+class TempDir {
+ public:
+  TempDir() {
+    char path[] = "/tmp/audio_preprocessor_testXXXXXX";
+    if (mkdtemp(path)) path_ = path;
+  }
+
+  ~TempDir() {
+    if (path_.empty()) return;
+    if (DIR* dir = opendir(path_.c_str())) {
+      while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name != "." && name != "..") unlink((path_ + "/" + name).c_str());
+      }
+      closedir(dir);
+    }
+    rmdir(path_.c_str());
+  }
+
+  TempDir(const TempDir&) = delete;
+  TempDir& operator=(const TempDir&) = delete;
+
+  const std::string& path() const { return path_; }
+  std::string file(const std::string& name) const { return path_ + "/" + name; }
+
+ private:
+  std::string path_;
+};
+
+inline bool write_file(const std::string& path, const std::vector<uint8_t>& bytes) {
+  FILE* f = fopen(path.c_str(), "wb");
+  if (!f) return false;
+  bool ok = fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+  return fclose(f) == 0 && ok;
+}
+
+/** 16-bit PCM WAV holding a sine whose frequency depends on seed. */
+inline std::vector<uint8_t> make_wav(size_t frames, int rate, int channels, int seed) {
+  std::vector<uint8_t> b;
+  auto put = [&](uint32_t v, int n) {
+    for (int k = 0; k < n; k++) b.push_back(static_cast<uint8_t>(v >> (8 * k)));
+  };
+  auto tag = [&](const char* t) { b.insert(b.end(), t, t + 4); };
+  uint32_t data_bytes = static_cast<uint32_t>(frames * channels * 2);
+  tag("RIFF");
+  put(36 + data_bytes, 4);
+  tag("WAVE");
+  tag("fmt ");
+  put(16, 4);
+  put(1, 2);
+  put(channels, 2);
+  put(rate, 4);
+  put(rate * channels * 2, 4);
+  put(channels * 2, 2);
+  put(16, 2);
+  tag("data");
+  put(data_bytes, 4);
+  for (size_t i = 0; i < frames; i++) {
+    double v = 0.5 * std::sin(2.0 * M_PI * (200.0 + 50.0 * seed) * i / rate);
+    for (int ch = 0; ch < channels; ch++) {
+      put(static_cast<uint16_t>(static_cast<int16_t>(v * 32767)), 2);
+    }
+  }
+  return b;
+}
+
+}  // namespace test_files
@@ -10,6 +10,8 @@
   defaultConfig {
     minSdk = 26
 
+    consumerProguardFiles("consumer-rules.pro")
+
     externalNativeBuild { cmake { arguments("-DANDROID_STL=c++_shared") } }
 
     ndk { abiFilters += listOf("arm64-v8a", "armeabi-v7a") }
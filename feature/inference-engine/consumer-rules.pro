@@ -0,0 +1,7 @@
+# NativeTranscript is constructed from whisper_jni.cpp by name and constructor signature.
+-keep class com.deeplayer.feature.inferenceengine.NativeTranscript {
+    <init>(...);
+}
+-keepclasseswithmembernames class com.deeplayer.feature.inferenceengine.WhisperNative {
+    native <methods>;
+}
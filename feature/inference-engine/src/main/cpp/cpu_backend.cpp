@@ -0,0 +1,231 @@
+#include "cpu_backend.h"
+
+#include <algorithm>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <utility>
+
+#include "ggml-backend.h"
+#include "whisper_log.h"
+
+#ifdef GGML_BACKEND_DL
+#include <dlfcn.h>
+
+#include "ggml-backend-impl.h"
+#endif
+
+namespace deeplayer {
+
+namespace {
+
+std::mutex g_mutex;
+std::string g_current;
+// Whisper contexts alive on g_current; the variant cannot change under them.
+int g_users = 0;
+
+#ifdef GGML_BACKEND_DL
+ggml_backend_reg_t g_reg = nullptr;
+
+// Directory holding libwhisper_jni.so. Variants are packaged next to it; on
+// Android this may be a path inside the APK ("base.apk!/lib/<abi>"), which
+// dlopen accepts as is.
+std::string library_dir() {
+  Dl_info info;
+  if (dladdr(reinterpret_cast<void *>(&library_dir), &info) && info.dli_fname) {
+    std::string path(info.dli_fname);
+    size_t slash = path.rfind('/');
+    if (slash != std::string::npos) return path.substr(0, slash + 1);
+  }
+  return "";
+}
+
+std::string variant_soname(const std::string &name) {
+  return "libggml-cpu-" + name + ".so";
+}
+
+// A variant library, opened once to read its score and kept open so the
+// chosen one is registered from the same handle. Closed on destruction
+// unless release()d to the registry.
+class VariantLibrary {
+public:
+  // Opens the variant next to libwhisper_jni.so, or by bare soname for the
+  // linker's own search path if dladdr gave nothing usable.
+  explicit VariantLibrary(std::string name) : name_(std::move(name)) {
+    for (const std::string &path :
+         {library_dir() + variant_soname(name_), variant_soname(name_)}) {
+      handle_ = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+      if (handle_) break;
+    }
+    if (!handle_) return;
+    // cpu-feats.cpp: 0 if this CPU lacks a required feature, higher for more.
+    using score_fn_t = int (*)();
+    auto score_fn = reinterpret_cast<score_fn_t>(dlsym(handle_, "ggml_backend_score"));
+    score_ = score_fn ? score_fn() : 1;
+  }
+
+  ~VariantLibrary() {
+    if (handle_) dlclose(handle_);
+  }
+
+  VariantLibrary(VariantLibrary &&other) noexcept
+      : name_(std::move(other.name_)), handle_(std::exchange(other.handle_, nullptr)),
+        score_(other.score_) {}
+
+  VariantLibrary &operator=(VariantLibrary &&other) noexcept {
+    std::swap(name_, other.name_);
+    std::swap(handle_, other.handle_);
+    std::swap(score_, other.score_);
+    return *this;
+  }
+
+  const std::string &name() const { return name_; }
+
+  // -1 if the library could not be opened.
+  int score() const { return score_; }
+
+  // The variant's backend registration, or null if it has none or was built
+  // against another ggml backend API.
+  ggml_backend_reg_t init() const {
+    if (!handle_) return nullptr;
+    using init_fn_t = ggml_backend_reg_t (*)();
+    auto init_fn = reinterpret_cast<init_fn_t>(dlsym(handle_, "ggml_backend_init"));
+    ggml_backend_reg_t reg = init_fn ? init_fn() : nullptr;
+    if (!reg || reg->api_version != GGML_BACKEND_API_VERSION) return nullptr;
+    return reg;
+  }
+
+  void *release() { return std::exchange(handle_, nullptr); }
+
+private:
+  std::string name_;
+  void *handle_ = nullptr;
+  int score_ = -1;
+};
+
+// Handle of g_reg's library. ggml_backend_register does not take ownership,
+// so it is closed here after the registration is removed.
+void *g_handle = nullptr;
+
+void unload_current() {
+  if (!g_reg) return;
+  ggml_backend_unload(g_reg);
+  dlclose(g_handle);
+  g_reg = nullptr;
+  g_handle = nullptr;
+  g_current.clear();
+}
+
+// Supported variants, highest score first, followed by the baseline even if
+// it scored 0: it is the last resort. Each library is opened once.
+std::vector<VariantLibrary> ranked_variants() {
+  std::vector<std::string> names = cpu_backend_variants();
+  std::vector<VariantLibrary> ranked;
+  std::optional<VariantLibrary> baseline;
+  for (const auto &name : names) {
+    VariantLibrary variant(name);
+    LOGI("CPU backend %s: score %d", name.c_str(), variant.score());
+    if (variant.score() > 0) {
+      ranked.push_back(std::move(variant));
+    } else if (variant.score() == 0 && name == names.back()) {
+      baseline.emplace(std::move(variant));
+    }
+  }
+  std::stable_sort(ranked.begin(), ranked.end(),
+                   [](const auto &a, const auto &b) { return a.score() > b.score(); });
+  if (baseline) ranked.push_back(std::move(*baseline));
+  return ranked;
+}
+
+// Register the first candidate whose backend initialises. Caller holds
+// g_mutex and has unloaded the previous variant.
+bool register_first(std::vector<VariantLibrary> &candidates) {
+  for (auto &variant : candidates) {
+    ggml_backend_reg_t reg = variant.init();
+    if (reg) {
+      ggml_backend_register(reg);
+      g_reg = reg;
+      g_handle = variant.release();
+      g_current = variant.name();
+      return true;
+    }
+    LOGE("Failed to initialise CPU backend %s", variant.name().c_str());
+  }
+  return false;
+}
+#endif
+
+} // namespace
+
+std::vector<std::string> cpu_backend_variants() {
+  std::vector<std::string> variants;
+#ifdef GGML_BACKEND_DL
+  std::stringstream ss(WHISPER_CPU_VARIANTS);
+  std::string name;
+  while (std::getline(ss, name, ',')) variants.push_back(name);
+#else
+  variants.emplace_back("builtin");
+#endif
+  return variants;
+}
+
+std::string load_cpu_backend(const std::string &name) {
+  std::lock_guard<std::mutex> lock(g_mutex);
+#ifdef GGML_BACKEND_DL
+  if (g_users > 0) {
+    LOGE("Cannot switch CPU backend while %d whisper context(s) are alive", g_users);
+    return "";
+  }
+
+  std::vector<VariantLibrary> candidates;
+  if (!name.empty()) {
+    VariantLibrary requested(name);
+    if (requested.score() <= 0) {
+      LOGE("CPU backend %s is not supported on this device", name.c_str());
+      return "";
+    }
+    candidates.push_back(std::move(requested));
+  }
+
+  unload_current();
+  if (!register_first(candidates)) {
+    // No request, or the requested variant failed after the old one was
+    // unloaded: never leave the process without a CPU backend.
+    candidates.clear();
+    candidates = ranked_variants();
+    if (!register_first(candidates)) {
+      LOGE("No CPU backend variant could be loaded");
+      return "";
+    }
+    if (!name.empty()) {
+      LOGE("Fell back to CPU backend %s", g_current.c_str());
+      return "";
+    }
+  }
+#else
+  // Single statically linked CPU backend (host builds)
+  if (!name.empty() && name != "builtin") return "";
+  g_current = "builtin";
+#endif
+  LOGI("Using CPU backend %s", g_current.c_str());
+  return g_current;
+}
+
+bool acquire_cpu_backend() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (g_current.empty()) return false;
+  g_users++;
+  return true;
+}
+
+void release_cpu_backend() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  if (g_users > 0) g_users--;
+}
+
+std::string current_cpu_backend() {
+  std::lock_guard<std::mutex> lock(g_mutex);
+  return g_current;
+}
+
+} // namespace deeplayer
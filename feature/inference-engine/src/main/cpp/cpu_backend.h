@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace deeplayer {
+
+/**
+ * Runtime selection of the ggml CPU backend variant.
+ *
+ * Each variant is a separate libggml-cpu-<name>.so built with a different
+ * instruction set (see CMakeLists.txt). Exactly one is registered with ggml
+ * at a time; whisper contexts created afterwards run on it. Nothing else in
+ * the process registers CPU backends: whisper.cpp is built without
+ * GGML_BACKEND_DL, so it never calls ggml_backend_load_all().
+ */
+
+/** Variants compiled into this build, most capable first. */
+std::vector<std::string> cpu_backend_variants();
+
+/**
+ * Register a CPU backend variant, replacing the current one.
+ *
+ * Refused while any whisper context is alive (see acquire_cpu_backend): the
+ * contexts hold buffers and kernels of the current variant.
+ * @param name Variant to load, or empty to pick the highest-scoring variant
+ *             supported by this CPU. If that fails to load, lower-scoring
+ *             variants are tried down to the baseline (the last in
+ *             cpu_backend_variants()), which runs on every device of the ABI.
+ * @return Name of the registered variant, or empty if the switch was refused
+ *         or the requested variant could not be loaded. A failed explicit
+ *         request still leaves the best loadable variant registered.
+ */
+std::string load_cpu_backend(const std::string &name);
+
+/**
+ * Count a whisper context about to be created on the registered variant.
+ * @return false, without counting, if no CPU backend is registered.
+ */
+bool acquire_cpu_backend();
+
+/** Release a count taken by acquire_cpu_backend() once the context is freed. */
+void release_cpu_backend();
+
+/** Name of the registered variant, or empty if none is loaded. */
+std::string current_cpu_backend();
+
+} // namespace deeplayer
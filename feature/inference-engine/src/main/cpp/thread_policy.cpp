@@ -0,0 +1,189 @@
+#include "thread_policy.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "whisper.h"
+#include "whisper_log.h"
+
+namespace deeplayer {
+
+namespace {
+
+constexpr const char *kCpuSysfsDir = "/sys/devices/system/cpu/";
+constexpr int kMaxDefaultThreads = 8;
+constexpr int kSampleRate = 16000;
+
+// Parses a sysfs CPU list such as "0-3,5,7-8".
+std::vector<int> parse_cpu_list(const std::string &list) {
+  std::vector<int> cpus;
+  size_t pos = 0;
+  while (pos < list.size()) {
+    size_t end = list.find(',', pos);
+    if (end == std::string::npos) end = list.size();
+    std::string range = list.substr(pos, end - pos);
+    size_t dash = range.find('-');
+    try {
+      int first = std::stoi(range.substr(0, dash));
+      int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+      for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    } catch (const std::exception &) {
+      // Malformed entry; skip it
+    }
+    pos = end + 1;
+  }
+  return cpus;
+}
+
+long read_max_freq_khz(int cpu) {
+  std::ifstream in(std::string(kCpuSysfsDir) + "cpu" + std::to_string(cpu) +
+                   "/cpufreq/cpuinfo_max_freq");
+  long khz = 0;
+  if (in) in >> khz;
+  return khz;
+}
+
+struct CpuInfo {
+  int id;
+  long max_freq_khz;
+};
+
+std::vector<CpuInfo> read_topology() {
+  std::vector<int> ids;
+  std::ifstream online(std::string(kCpuSysfsDir) + "online");
+  std::string list;
+  if (online && std::getline(online, list)) ids = parse_cpu_list(list);
+  if (ids.empty()) {
+    int n = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    for (int i = 0; i < n; i++) ids.push_back(i);
+  }
+
+  std::vector<CpuInfo> cpus;
+  cpus.reserve(ids.size());
+  for (int id : ids) cpus.push_back({id, read_max_freq_khz(id)});
+  std::stable_sort(cpus.begin(), cpus.end(), [](const CpuInfo &a, const CpuInfo &b) {
+    return a.max_freq_khz > b.max_freq_khz;
+  });
+  return cpus;
+}
+
+// Topology does not change while the process runs.
+const std::vector<CpuInfo> &topology() {
+  static const std::vector<CpuInfo> cpus = read_topology();
+  return cpus;
+}
+
+} // namespace
+
+std::vector<int> cpus_by_speed() {
+  std::vector<int> ids;
+  for (const auto &cpu : topology()) ids.push_back(cpu.id);
+  return ids;
+}
+
+int default_thread_count() {
+  const auto &cpus = topology();
+  long fastest = cpus.front().max_freq_khz;
+  int n = 0;
+  for (const auto &cpu : cpus) {
+    if (cpu.max_freq_khz * 5 >= fastest * 4) n++;
+  }
+  return std::clamp(n, 1, kMaxDefaultThreads);
+}
+
+ScopedAffinity::ScopedAffinity(int n_threads) {
+#ifdef __linux__
+  const auto &cpus = topology();
+  // Without frequency information every core looks alike; leave the
+  // scheduler alone rather than pinning to arbitrary low ids.
+  if (cpus.front().max_freq_khz <= 0) return;
+  if (sched_getaffinity(0, sizeof(saved_), &saved_) != 0) return;
+
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  int n = std::clamp(n_threads, 1, static_cast<int>(cpus.size()));
+  for (int i = 0; i < n; i++) CPU_SET(cpus[i].id, &mask);
+  if (sched_setaffinity(0, sizeof(mask), &mask) == 0) {
+    restore_ = true;
+  } else {
+    LOGE("sched_setaffinity failed for %d threads", n);
+  }
+#else
+  (void)n_threads;
+#endif
+}
+
+ScopedAffinity::~ScopedAffinity() {
+#ifdef __linux__
+  if (restore_) sched_setaffinity(0, sizeof(saved_), &saved_);
+#endif
+}
+
+int calibrate_thread_count(whisper_context *ctx, int max_threads,
+                           const std::function<bool()> &should_stop) {
+  const int warmup_threads = default_thread_count();
+  max_threads = std::clamp(max_threads, 1, static_cast<int>(topology().size()));
+  if (should_stop()) return 0;
+
+  // A private state keeps the context's own state free for transcription.
+  std::unique_ptr<whisper_state, decltype(&whisper_free_state)> state(
+      whisper_init_state(ctx), &whisper_free_state);
+  if (!state) {
+    LOGE("Calibration: failed to allocate a whisper state");
+    return 0;
+  }
+
+  // The encoder always runs on a full 30 s window, so a short clip suffices.
+  std::vector<float> silence(kSampleRate, 0.0f);
+  if (whisper_pcm_to_mel_with_state(ctx, state.get(), silence.data(),
+                                    static_cast<int>(silence.size()),
+                                    warmup_threads) != 0) {
+    LOGE("Calibration: failed to compute mel");
+    return 0;
+  }
+
+  // Warm-up: first run allocates compute buffers
+  {
+    ScopedAffinity affinity(warmup_threads);
+    if (whisper_encode_with_state(ctx, state.get(), 0, warmup_threads) != 0) {
+      LOGE("Calibration: encoder failed");
+      return 0;
+    }
+  }
+
+  std::vector<double> times_ms(max_threads + 1, 0.0);
+  double best_ms = -1.0;
+  for (int n = 1; n <= max_threads; n++) {
+    if (should_stop()) {
+      LOGI("Calibration: interrupted before %d threads", n);
+      return 0;
+    }
+    ScopedAffinity affinity(n);
+    auto start = std::chrono::steady_clock::now();
+    if (whisper_encode_with_state(ctx, state.get(), 0, n) != 0) {
+      LOGE("Calibration: encoder failed with %d threads", n);
+      return 0;
+    }
+    times_ms[n] = std::chrono::duration<double, std::milli>(
+                      std::chrono::steady_clock::now() - start)
+                      .count();
+    LOGI("Calibration: %d threads -> %.1f ms", n, times_ms[n]);
+    if (best_ms < 0 || times_ms[n] < best_ms) best_ms = times_ms[n];
+  }
+  // A stop raised during the last pass means it shared the cores.
+  if (should_stop()) return 0;
+
+  for (int n = 1; n <= max_threads; n++) {
+    if (times_ms[n] <= best_ms * 1.03) {
+      LOGI("Calibration: using %d threads", n);
+      return n;
+    }
+  }
+  return 0;
+}
+
+} // namespace deeplayer
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+struct whisper_context;
+
+namespace deeplayer {
+
+/**
+ * Inference thread placement for heterogeneous (big.LITTLE) CPUs.
+ *
+ * ggml's compute threads synchronise on a barrier after every op, so one
+ * thread on an efficiency core stalls all of them. Threads are therefore
+ * pinned to the fastest cores by max frequency read from sysfs.
+ */
+
+/** Online CPU ids ordered fastest first (max frequency, then id). */
+std::vector<int> cpus_by_speed();
+
+/**
+ * Thread count used when none is configured: the cores within 80% of the
+ * fastest core's max frequency (prime + performance clusters), capped at 8.
+ */
+int default_thread_count();
+
+/**
+ * Pin the calling thread to the `n_threads` fastest CPUs for this scope.
+ * Threads it spawns (ggml's compute workers) inherit the mask. The previous
+ * mask is restored on destruction. No-op where affinity is unsupported.
+ */
+class ScopedAffinity {
+ public:
+  explicit ScopedAffinity(int n_threads);
+  ~ScopedAffinity();
+
+  ScopedAffinity(const ScopedAffinity &) = delete;
+  ScopedAffinity &operator=(const ScopedAffinity &) = delete;
+
+ private:
+#ifdef __linux__
+  cpu_set_t saved_;
+#endif
+  bool restore_ = false;
+};
+
+/**
+ * Time the encoder on a short silent clip for 1..max_threads threads (each
+ * pinned to the fastest cores) and return the fastest count. Counts within 3%
+ * of the best prefer fewer threads. Returns 0 on error, so that callers never
+ * mistake a failed run for a measurement and persist it.
+ *
+ * Runs on a whisper_state of its own, so it may overlap transcription on the
+ * same context. should_stop is polled around every encoder pass; once it
+ * returns true (e.g. a transcription started and the timings would be
+ * skewed) calibration gives up and returns 0.
+ */
+int calibrate_thread_count(whisper_context *ctx, int max_threads,
+                           const std::function<bool()> &should_stop);
+
+} // namespace deeplayer
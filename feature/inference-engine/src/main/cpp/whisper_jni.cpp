@@ -1,22 +1,105 @@
 #include <jni.h>
+#include <cstdint>
 #include <cstring>
 #include <string>
 #include <vector>
+#include "cpu_backend.h"
+#include "thread_policy.h"
 #include "whisper.h"
+#include "whisper_log.h"
 
-#ifdef __ANDROID__
-#include <android/log.h>
-#define TAG "WhisperJNI"
-#define LOGI(...) __android_log_print(ANDROID_LOG_INFO, TAG, __VA_ARGS__)
-#define LOGE(...) __android_log_print(ANDROID_LOG_ERROR, TAG, __VA_ARGS__)
-#else
-#include <cstdio>
-#define LOGI(...) do { fprintf(stderr, "[WhisperJNI INFO] "); fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while(0)
-#define LOGE(...) do { fprintf(stderr, "[WhisperJNI ERROR] "); fprintf(stderr, __VA_ARGS__); fprintf(stderr, "\n"); } while(0)
-#endif
+namespace {
+
+// Class and constructor of the packed result, resolved once in JNI_OnLoad.
+// FindClass from a native worker thread would resolve against the system class
+// loader, and resolving per call costs a lookup on every transcription.
+jclass g_transcriptClass = nullptr;
+jmethodID g_transcriptCtor = nullptr;
+
+constexpr const char *kTranscriptClassName =
+    "com/deeplayer/feature/inferenceengine/NativeTranscript";
+constexpr const char *kTranscriptCtorSig = "([J[I[B[I[F)V";
+
+// Copies a native buffer into a new Java primitive array. Returns nullptr with a
+// pending OutOfMemoryError if the allocation fails.
+jlongArray toJava(JNIEnv *env, const std::vector<jlong> &v) {
+  jlongArray arr = env->NewLongArray(static_cast<jsize>(v.size()));
+  if (arr && !v.empty()) {
+    env->SetLongArrayRegion(arr, 0, static_cast<jsize>(v.size()), v.data());
+  }
+  return arr;
+}
+
+jintArray toJava(JNIEnv *env, const std::vector<jint> &v) {
+  jintArray arr = env->NewIntArray(static_cast<jsize>(v.size()));
+  if (arr && !v.empty()) {
+    env->SetIntArrayRegion(arr, 0, static_cast<jsize>(v.size()), v.data());
+  }
+  return arr;
+}
+
+jbyteArray toJava(JNIEnv *env, const std::vector<jbyte> &v) {
+  jbyteArray arr = env->NewByteArray(static_cast<jsize>(v.size()));
+  if (arr && !v.empty()) {
+    env->SetByteArrayRegion(arr, 0, static_cast<jsize>(v.size()), v.data());
+  }
+  return arr;
+}
+
+jfloatArray toJava(JNIEnv *env, const std::vector<jfloat> &v) {
+  jfloatArray arr = env->NewFloatArray(static_cast<jsize>(v.size()));
+  if (arr && !v.empty()) {
+    env->SetFloatArrayRegion(arr, 0, static_cast<jsize>(v.size()), v.data());
+  }
+  return arr;
+}
+
+} // namespace
 
 extern "C" {
 
+JNIEXPORT jint JNICALL JNI_OnLoad(JavaVM *vm, void * /* reserved */) {
+  JNIEnv *env = nullptr;
+  if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+    return JNI_ERR;
+  }
+
+  jclass local = env->FindClass(kTranscriptClassName);
+  if (!local) {
+    LOGE("Failed to find class %s", kTranscriptClassName);
+    return JNI_ERR;
+  }
+  g_transcriptClass = static_cast<jclass>(env->NewGlobalRef(local));
+  env->DeleteLocalRef(local);
+  g_transcriptCtor =
+      env->GetMethodID(g_transcriptClass, "<init>", kTranscriptCtorSig);
+  if (!g_transcriptCtor) {
+    LOGE("Failed to find %s constructor", kTranscriptClassName);
+    return JNI_ERR;
+  }
+
+  // Register the best ggml CPU kernels for this device before any model loads.
+  // load_cpu_backend already falls back to the baseline variant; if even that
+  // fails, keep the library usable for queries and let init() report it.
+  if (deeplayer::load_cpu_backend("").empty()) {
+    LOGW("No ggml CPU backend could be loaded; models will fail to initialise");
+  }
+
+  return JNI_VERSION_1_6;
+}
+
+JNIEXPORT void JNICALL JNI_OnUnload(JavaVM *vm, void * /* reserved */) {
+  JNIEnv *env = nullptr;
+  if (vm->GetEnv(reinterpret_cast<void **>(&env), JNI_VERSION_1_6) != JNI_OK) {
+    return;
+  }
+  if (g_transcriptClass) {
+    env->DeleteGlobalRef(g_transcriptClass);
+    g_transcriptClass = nullptr;
+  }
+  g_transcriptCtor = nullptr;
+}
+
 JNIEXPORT jlong JNICALL
 Java_com_deeplayer_feature_inferenceengine_WhisperNative_init(
     JNIEnv *env, jobject /* this */, jstring modelPath) {
@@ -26,23 +109,33 @@ Java_com_deeplayer_feature_inferenceengine_WhisperNative_init(
     return 0;
   }
 
+  // Counted before the context exists so the CPU backend cannot be swapped
+  // while it is being built.
+  if (!deeplayer::acquire_cpu_backend()) {
+    LOGE("No CPU backend is loaded; cannot initialise %s", path);
+    env->ReleaseStringUTFChars(modelPath, path);
+    return 0;
+  }
+
   struct whisper_context_params cparams = whisper_context_default_params();
   struct whisper_context *ctx = whisper_init_from_file_with_params(path, cparams);
-  env->ReleaseStringUTFChars(modelPath, path);
 
   if (!ctx) {
     LOGE("Failed to initialize whisper context from: %s", path);
+    env->ReleaseStringUTFChars(modelPath, path);
+    deeplayer::release_cpu_backend();
     return 0;
   }
+  env->ReleaseStringUTFChars(modelPath, path);
 
   LOGI("Whisper model loaded successfully");
   return reinterpret_cast<jlong>(ctx);
 }
 
-JNIEXPORT jobjectArray JNICALL
+JNIEXPORT jobject JNICALL
 Java_com_deeplayer_feature_inferenceengine_WhisperNative_transcribe(
     JNIEnv *env, jobject /* this */, jlong ctxPtr, jfloatArray pcmArray,
-    jstring langStr) {
+    jstring langStr, jboolean withTokenProbs, jint nThreads) {
   auto *ctx = reinterpret_cast<struct whisper_context *>(ctxPtr);
   if (!ctx) {
     LOGE("Null whisper context");
@@ -73,11 +166,15 @@ Java_com_deeplayer_feature_inferenceengine_WhisperNative_transcribe(
   params.print_realtime = false;
   params.print_special = false;
   params.print_timestamps = false;
-  params.n_threads = 4;
+  params.n_threads = nThreads > 0 ? nThreads : deeplayer::default_thread_count();
   params.no_context = true;
 
-  // Run inference
-  int ret = whisper_full(ctx, params, pcmData, pcmLen);
+  // Run inference with ggml workers pinned to the fastest cores
+  int ret;
+  {
+    deeplayer::ScopedAffinity affinity(params.n_threads);
+    ret = whisper_full(ctx, params, pcmData, pcmLen);
+  }
   env->ReleaseStringUTFChars(langStr, lang);
   env->ReleaseFloatArrayElements(pcmArray, pcmData, JNI_ABORT);
 
@@ -90,35 +187,92 @@ Java_com_deeplayer_feature_inferenceengine_WhisperNative_transcribe(
   int n_segments = whisper_full_n_segments(ctx);
   LOGI("Transcription produced %d segments", n_segments);
 
-  // Result: array of String[] where each element is [text, startMs, endMs]
-  jclass stringClass = env->FindClass("java/lang/String");
-  // Create outer array: n_segments x 3
-  jclass stringArrayClass = env->FindClass("[Ljava/lang/String;");
-  jobjectArray result =
-      env->NewObjectArray(n_segments, stringArrayClass, nullptr);
+  // Packed result (see NativeTranscript):
+  //   timesMs[2*i], timesMs[2*i+1]  start/end of segment i in milliseconds
+  //   textOffsets[i]..[i+1]         byte range of segment i in text
+  //   tokenOffsets[i]..[i+1]        range of segment i in tokenProbs (optional)
+  std::vector<jlong> times_ms(static_cast<size_t>(n_segments) * 2);
+  std::vector<jint> text_offsets(static_cast<size_t>(n_segments) + 1);
+  std::vector<jbyte> text;
+  std::vector<jint> token_offsets;
+  std::vector<jfloat> token_probs;
+  if (withTokenProbs) {
+    token_offsets.resize(static_cast<size_t>(n_segments) + 1);
+  }
+  // Special and timestamp tokens all sort at or after end-of-text.
+  const whisper_token token_eot = whisper_token_eot(ctx);
 
+  text_offsets[0] = 0;
   for (int i = 0; i < n_segments; i++) {
-    const char *text = whisper_full_get_segment_text(ctx, i);
-    int64_t t0 = whisper_full_get_segment_t0(ctx, i); // in centiseconds
-    int64_t t1 = whisper_full_get_segment_t1(ctx, i);
+    // t0/t1 are in centiseconds
+    times_ms[2 * i] = static_cast<jlong>(whisper_full_get_segment_t0(ctx, i)) * 10;
+    times_ms[2 * i + 1] = static_cast<jlong>(whisper_full_get_segment_t1(ctx, i)) * 10;
 
-    long startMs = t0 * 10; // centiseconds to milliseconds
-    long endMs = t1 * 10;
+    // Raw UTF-8 bytes; may contain partial sequences at BPE token boundaries,
+    // which NewStringUTF would reject. Decoding happens on the Kotlin side.
+    const char *seg_text = whisper_full_get_segment_text(ctx, i);
+    const size_t len = seg_text ? strlen(seg_text) : 0;
+    text.insert(text.end(), reinterpret_cast<const jbyte *>(seg_text),
+                reinterpret_cast<const jbyte *>(seg_text) + len);
+    text_offsets[i + 1] = static_cast<jint>(text.size());
 
-    jobjectArray segArray = env->NewObjectArray(3, stringClass, nullptr);
-    env->SetObjectArrayElement(segArray, 0, env->NewStringUTF(text));
-    env->SetObjectArrayElement(
-        segArray, 1,
-        env->NewStringUTF(std::to_string(startMs).c_str()));
-    env->SetObjectArrayElement(
-        segArray, 2,
-        env->NewStringUTF(std::to_string(endMs).c_str()));
+    if (withTokenProbs) {
+      token_offsets[i] = static_cast<jint>(token_probs.size());
+      int n_tokens = whisper_full_n_tokens(ctx, i);
+      for (int j = 0; j < n_tokens; j++) {
+        if (whisper_full_get_token_id(ctx, i, j) >= token_eot) continue;
+        token_probs.push_back(whisper_full_get_token_p(ctx, i, j));
+      }
+    }
+  }
+  if (withTokenProbs) {
+    token_offsets[n_segments] = static_cast<jint>(token_probs.size());
+  }
 
-    env->SetObjectArrayElement(result, i, segArray);
-    env->DeleteLocalRef(segArray);
+  jlongArray jtimes = toJava(env, times_ms);
+  if (!jtimes) return nullptr;
+  jintArray joffsets = toJava(env, text_offsets);
+  if (!joffsets) return nullptr;
+  jbyteArray jtext = toJava(env, text);
+  if (!jtext) return nullptr;
+  jintArray jtokenOffsets = nullptr;
+  jfloatArray jtokenProbs = nullptr;
+  if (withTokenProbs) {
+    jtokenOffsets = toJava(env, token_offsets);
+    if (!jtokenOffsets) return nullptr;
+    jtokenProbs = toJava(env, token_probs);
+    if (!jtokenProbs) return nullptr;
   }
 
-  return result;
+  return env->NewObject(g_transcriptClass, g_transcriptCtor, jtimes, joffsets,
+                        jtext, jtokenOffsets, jtokenProbs);
+}
+
+JNIEXPORT jint JNICALL
+Java_com_deeplayer_feature_inferenceengine_WhisperNative_defaultThreadCount(
+    JNIEnv * /* env */, jobject /* this */) {
+  return deeplayer::default_thread_count();
+}
+
+JNIEXPORT jint JNICALL
+Java_com_deeplayer_feature_inferenceengine_WhisperNative_calibrateThreadCount(
+    JNIEnv *env, jobject /* this */, jlong ctxPtr, jint maxThreads,
+    jobject shouldStop) {
+  auto *ctx = reinterpret_cast<struct whisper_context *>(ctxPtr);
+  if (!ctx) {
+    LOGE("Null whisper context");
+    return 0;
+  }
+  jclass supplierClass = env->GetObjectClass(shouldStop);
+  jmethodID getAsBoolean = env->GetMethodID(supplierClass, "getAsBoolean", "()Z");
+  env->DeleteLocalRef(supplierClass);
+  if (!getAsBoolean) return 0;
+
+  // Polled on this thread between encoder passes; a Java exception stops too.
+  return deeplayer::calibrate_thread_count(ctx, maxThreads, [&]() {
+    return env->CallBooleanMethod(shouldStop, getAsBoolean) == JNI_TRUE ||
+           env->ExceptionCheck();
+  });
 }
 
 JNIEXPORT void JNICALL
@@ -127,8 +281,46 @@ Java_com_deeplayer_feature_inferenceengine_WhisperNative_free(
   auto *ctx = reinterpret_cast<struct whisper_context *>(ctxPtr);
   if (ctx) {
     whisper_free(ctx);
+    deeplayer::release_cpu_backend();
     LOGI("Whisper context freed");
   }
 }
 
+JNIEXPORT jobjectArray JNICALL
+Java_com_deeplayer_feature_inferenceengine_WhisperNative_cpuVariants(
+    JNIEnv *env, jobject /* this */) {
+  std::vector<std::string> variants = deeplayer::cpu_backend_variants();
+  jclass stringClass = env->FindClass("java/lang/String");
+  jobjectArray result = env->NewObjectArray(
+      static_cast<jsize>(variants.size()), stringClass, nullptr);
+  if (!result) return nullptr;
+  for (size_t i = 0; i < variants.size(); i++) {
+    jstring name = env->NewStringUTF(variants[i].c_str());
+    env->SetObjectArrayElement(result, static_cast<jsize>(i), name);
+    env->DeleteLocalRef(name);
+  }
+  return result;
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_deeplayer_feature_inferenceengine_WhisperNative_cpuVariant(
+    JNIEnv *env, jobject /* this */) {
+  std::string current = deeplayer::current_cpu_backend();
+  return current.empty() ? nullptr : env->NewStringUTF(current.c_str());
+}
+
+JNIEXPORT jstring JNICALL
+Java_com_deeplayer_feature_inferenceengine_WhisperNative_selectCpuVariant(
+    JNIEnv *env, jobject /* this */, jstring nameStr) {
+  std::string name;
+  if (nameStr) {
+    const char *chars = env->GetStringUTFChars(nameStr, nullptr);
+    if (!chars) return nullptr;
+    name = chars;
+    env->ReleaseStringUTFChars(nameStr, chars);
+  }
+  std::string loaded = deeplayer::load_cpu_backend(name);
+  return loaded.empty() ? nullptr : env->NewStringUTF(loaded.c_str());
+}
+
 } // extern "C"
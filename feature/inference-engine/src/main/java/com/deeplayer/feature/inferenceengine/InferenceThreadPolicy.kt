@@ -0,0 +1,80 @@
+package com.deeplayer.feature.inferenceengine
+
+import android.content.SharedPreferences
+
+/**
+ * Chooses how many threads whisper.cpp runs with. Threads are always pinned to the fastest cores
+ * natively; this only decides the count, in order of precedence:
+ * 1. [overrideThreadCount], if set from Kotlin (e.g. a settings screen or benchmark).
+ * 2. The count found by a one-time on-device calibration, persisted in [prefs].
+ * 3. The topology-based default, if calibration is disabled or has not finished yet.
+ *
+ * Calibration itself runs off the request path (see [WhisperCppTranscriber]); this class only
+ * says whether it is still needed and stores the result.
+ *
+ * @param prefs where the calibration result and override are persisted; null keeps them in memory.
+ * @param calibrate whether to measure the thread count on device; false always uses the default.
+ */
+class InferenceThreadPolicy(
+  private val prefs: SharedPreferences? = null,
+  private val calibrate: Boolean = true,
+) {
+
+  @Volatile private var memoryOverride: Int? = null
+  @Volatile private var memoryCalibrated: Int? = null
+
+  /** Forced thread count, or null to use calibration / default. Persisted in [prefs]. */
+  var overrideThreadCount: Int?
+    get() = if (prefs != null) prefs.getInt(KEY_OVERRIDE, 0).takeIf { it > 0 } else memoryOverride
+    set(value) {
+      require(value == null || value > 0) { "Thread count must be positive: $value" }
+      memoryOverride = value
+      val editor = prefs?.edit() ?: return
+      if (value == null) editor.remove(KEY_OVERRIDE) else editor.putInt(KEY_OVERRIDE, value)
+      editor.apply()
+    }
+
+  /** Persisted calibration result, or null if calibration has not run. */
+  val calibratedThreadCount: Int?
+    get() =
+      if (prefs != null) prefs.getInt(KEY_CALIBRATED, 0).takeIf { it > 0 } else memoryCalibrated
+
+  /** True while calibration is enabled and neither an override nor a result is stored. */
+  val needsCalibration: Boolean
+    get() = calibrate && overrideThreadCount == null && calibratedThreadCount == null
+
+  /** Drop the persisted calibration so that it is measured again. */
+  fun resetCalibration() {
+    memoryCalibrated = null
+    prefs?.edit()?.remove(KEY_CALIBRATED)?.apply()
+  }
+
+  /**
+   * Store a calibration result. Non-positive [measured] means the run failed or was interrupted
+   * and is ignored, so calibration is retried later.
+   *
+   * @return whether the result was stored.
+   */
+  fun recordCalibration(measured: Int): Boolean {
+    if (measured <= 0) return false
+    memoryCalibrated = measured
+    prefs?.edit()?.putInt(KEY_CALIBRATED, measured)?.apply()
+    return true
+  }
+
+  /**
+   * Thread count for the next inference. Never blocks on calibration.
+   *
+   * @param defaultCount topology-based fallback.
+   */
+  fun resolve(defaultCount: () -> Int): Int =
+    overrideThreadCount ?: calibratedThreadCount ?: defaultCount()
+
+  companion object {
+    /** Upper bound on thread counts tried during calibration. */
+    const val MAX_CALIBRATION_THREADS = 8
+
+    private const val KEY_OVERRIDE = "whisper_thread_count_override"
+    private const val KEY_CALIBRATED = "whisper_thread_count_calibrated"
+  }
+}
@@ -0,0 +1,42 @@
+package com.deeplayer.feature.inferenceengine
+
+/**
+ * Packed transcription result built by `whisper_jni.cpp`. Segments are stored column-wise in
+ * primitive arrays so a transcription costs a fixed handful of JNI allocations regardless of
+ * segment count:
+ * - [timesMs]: `[start0, end0, start1, end1, ...]` in milliseconds.
+ * - [textOffsets]: `n + 1` byte offsets into [text]; segment `i` is `[offsets[i], offsets[i+1])`.
+ * - [text]: raw UTF-8 bytes of all segments concatenated.
+ * - [tokenOffsets] / [tokenProbs]: optional per-token probabilities (text tokens only), laid out
+ *   like [textOffsets] / [text]. Null unless requested.
+ *
+ * The constructor signature is looked up from native code; keep it in sync with
+ * `kTranscriptCtorSig`.
+ */
+internal class NativeTranscript(
+  val timesMs: LongArray,
+  val textOffsets: IntArray,
+  val text: ByteArray,
+  val tokenOffsets: IntArray?,
+  val tokenProbs: FloatArray?,
+) {
+  val size: Int
+    get() = textOffsets.size - 1
+
+  fun startMs(index: Int): Long = timesMs[2 * index]
+
+  fun endMs(index: Int): Long = timesMs[2 * index + 1]
+
+  /** Decode segment [index] text. Malformed UTF-8 (split BPE tokens) becomes U+FFFD. */
+  fun text(index: Int): String {
+    val from = textOffsets[index]
+    return String(text, from, textOffsets[index + 1] - from, Charsets.UTF_8)
+  }
+
+  /** Per-token probabilities of segment [index], or null if they were not requested. */
+  fun tokenProbs(index: Int): FloatArray? {
+    val offsets = tokenOffsets ?: return null
+    val probs = tokenProbs ?: return null
+    return probs.copyOfRange(offsets[index], offsets[index + 1])
+  }
+}
@@ -3,16 +3,46 @@
 import com.deeplayer.core.contracts.Language
 import com.deeplayer.core.contracts.TranscribedSegment
 import com.deeplayer.core.contracts.WhisperTranscriber
+import java.util.concurrent.Executors
+import java.util.concurrent.ScheduledExecutorService
+import java.util.concurrent.ScheduledFuture
+import java.util.concurrent.TimeUnit
+import java.util.concurrent.atomic.AtomicInteger
+import java.util.function.BooleanSupplier
 
-/** [WhisperTranscriber] backed by whisper.cpp via JNI. */
-class WhisperCppTranscriber : WhisperTranscriber {
+/**
+ * [WhisperTranscriber] backed by whisper.cpp via JNI.
+ *
+ * Thread count calibration never runs inside [transcribe]. Once a model is loaded, it is scheduled
+ * on a background thread after [CALIBRATION_IDLE_DELAY_MS] without transcription, and abandons
+ * its run as soon as a transcription starts (to be rescheduled after it). Until a result is
+ * stored, transcription uses the policy's override or the topology default.
+ *
+ * @param threadPolicy decides the inference thread count (calibrated, overridden or default).
+ */
+class WhisperCppTranscriber(
+  private val threadPolicy: InferenceThreadPolicy = InferenceThreadPolicy()
+) : WhisperTranscriber {
 
   private val native = WhisperNative()
-  private var ctx: Long = 0L
+  @Volatile private var ctx: Long = 0L
+
+  // Calibration runs on its own whisper state, so it may overlap a transcription on the same
+  // context; these let it notice one and stop. The lock keeps close() from freeing the context
+  // under a running calibration.
+  private val calibrationLock = Any()
+  private val activeTranscriptions = AtomicInteger()
+  private val transcriptionsStarted = AtomicInteger()
+  @Volatile private var closing = false
+  private var calibrationExecutor: ScheduledExecutorService? = null
+  private var pendingCalibration: ScheduledFuture<*>? = null
 
   override fun loadModel(modelPath: String): Boolean {
+    closing = false
     ctx = native.init(modelPath)
-    return ctx != 0L
+    if (ctx == 0L) return false
+    scheduleCalibration()
+    return true
   }
 
   override fun transcribe(pcm: FloatArray, language: Language): List<TranscribedSegment> {
@@ -23,37 +53,134 @@ override fun transcribe(pcm: FloatArray, language: Language): List<TranscribedSe
         Language.EN -> "en"
         Language.MIXED -> "ko" // default to Korean for mixed content
       }
-    val raw = native.transcribe(ctx, pcm, lang) ?: return emptyList()
-    return raw.mapNotNull { seg ->
-      if (seg.size < 3) return@mapNotNull null
-      val text = sanitizeText(seg[0])
-      if (text.isBlank()) return@mapNotNull null
-      val startMs = seg[1].toLongOrNull() ?: return@mapNotNull null
-      val endMs = seg[2].toLongOrNull() ?: return@mapNotNull null
-      if (startMs < 0 || endMs < startMs) return@mapNotNull null
-      TranscribedSegment(text = text, startMs = startMs, endMs = endMs)
+    activeTranscriptions.incrementAndGet()
+    transcriptionsStarted.incrementAndGet()
+    cancelPendingCalibration()
+    try {
+      val nThreads = threadPolicy.resolve(defaultCount = { native.defaultThreadCount() })
+      val raw =
+        native.transcribe(ctx, pcm, lang, withTokenProbs = false, nThreads = nThreads)
+          ?: return emptyList()
+      return toSegments(raw)
+    } finally {
+      activeTranscriptions.decrementAndGet()
+      scheduleCalibration()
     }
   }
 
-  /**
-   * Strip control characters, isolated surrogate bytes, and punctuation-only text that Whisper
-   * sometimes emits for non-English languages (broken BPE token boundaries).
-   */
-  private fun sanitizeText(raw: String): String {
-    // Remove control characters and isolated surrogates
-    val cleaned =
-      raw
-        .filter { c -> !c.isISOControl() && !c.isSurrogate() }
-        .trim()
-    // Skip segments that are only punctuation/brackets/whitespace
-    if (cleaned.all { !it.isLetterOrDigit() }) return ""
-    return cleaned
+  override fun close() {
+    closing = true
+    synchronized(this) {
+      pendingCalibration?.cancel(false)
+      pendingCalibration = null
+      calibrationExecutor?.shutdown()
+      calibrationExecutor = null
+    }
+    // Waits for at most the encoder pass in flight: calibration polls `closing` between passes.
+    synchronized(calibrationLock) {
+      if (ctx != 0L) {
+        native.free(ctx)
+        ctx = 0L
+      }
+    }
   }
 
-  override fun close() {
-    if (ctx != 0L) {
-      native.free(ctx)
-      ctx = 0L
+  /** (Re)start the idle countdown to a calibration run, if one is still needed. */
+  @Synchronized
+  private fun scheduleCalibration() {
+    if (closing || !threadPolicy.needsCalibration) return
+    pendingCalibration?.cancel(false)
+    val executor =
+      calibrationExecutor
+        ?: Executors.newSingleThreadScheduledExecutor(::newCalibrationThread).also {
+          calibrationExecutor = it
+        }
+    pendingCalibration =
+      executor.schedule(
+        Runnable { runCalibration() },
+        CALIBRATION_IDLE_DELAY_MS,
+        TimeUnit.MILLISECONDS,
+      )
+  }
+
+  private fun newCalibrationThread(runnable: Runnable): Thread =
+    Thread(runnable, "whisper-calibration").apply { isDaemon = true }
+
+  @Synchronized
+  private fun cancelPendingCalibration() {
+    pendingCalibration?.cancel(false)
+    pendingCalibration = null
+  }
+
+  private fun runCalibration() {
+    synchronized(calibrationLock) {
+      val handle = ctx
+      if (handle == 0L || closing || !threadPolicy.needsCalibration) return
+      val started = transcriptionsStarted.get()
+      val interrupted = BooleanSupplier {
+        closing || activeTranscriptions.get() > 0 || transcriptionsStarted.get() != started
+      }
+      val measured =
+        native.calibrateThreadCount(
+          handle,
+          InferenceThreadPolicy.MAX_CALIBRATION_THREADS,
+          interrupted,
+        )
+      threadPolicy.recordCalibration(measured)
+    }
+  }
+
+  companion object {
+    /** Quiet period after model load or the last transcription before calibration starts. */
+    const val CALIBRATION_IDLE_DELAY_MS = 10_000L
+
+    private val sharedNative by lazy { WhisperNative() }
+
+    /**
+     * ggml CPU kernel variants in this build (e.g. `armv8_6_i8mm`, `armv8_2_dotprod`, `armv8_0`),
+     * most capable first. The best one the device supports is selected when the library loads.
+     */
+    fun cpuVariants(): List<String> = sharedNative.cpuVariants().toList()
+
+    /** CPU kernel variant currently used for inference. */
+    fun cpuVariant(): String? = sharedNative.cpuVariant()
+
+    /**
+     * Switch CPU kernel variant, e.g. to benchmark each one. The switch is refused while any
+     * transcriber has a model loaded, since its buffers belong to the current variant.
+     *
+     * @param name variant from [cpuVariants], or null to re-select the best supported one.
+     * @return the variant now in use, or null if a model is loaded or [name] is unsupported on this
+     *   device.
+     */
+    fun selectCpuVariant(name: String?): String? = sharedNative.selectCpuVariant(name)
+
+    internal fun toSegments(raw: NativeTranscript): List<TranscribedSegment> {
+      val segments = ArrayList<TranscribedSegment>(raw.size)
+      for (i in 0 until raw.size) {
+        val text = sanitizeText(raw.text(i))
+        if (text.isBlank()) continue
+        val startMs = raw.startMs(i)
+        val endMs = raw.endMs(i)
+        if (startMs < 0 || endMs < startMs) continue
+        segments.add(TranscribedSegment(text = text, startMs = startMs, endMs = endMs))
+      }
+      return segments
+    }
+
+    /**
+     * Strip control characters, isolated surrogates, replacement characters, and punctuation-only
+     * text that Whisper sometimes emits for non-English languages (broken BPE token boundaries).
+     */
+    private fun sanitizeText(raw: String): String {
+      // Remove control characters, isolated surrogates and undecodable UTF-8 bytes
+      val cleaned =
+        raw
+          .filter { c -> !c.isISOControl() && !c.isSurrogate() && c != '\uFFFD' }
+          .trim()
+      // Skip segments that are only punctuation/brackets/whitespace
+      if (cleaned.all { !it.isLetterOrDigit() }) return ""
+      return cleaned
     }
   }
 }
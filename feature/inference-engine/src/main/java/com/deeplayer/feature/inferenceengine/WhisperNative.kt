@@ -1,5 +1,7 @@
 package com.deeplayer.feature.inferenceengine
 
+import java.util.function.BooleanSupplier
+
 /**
  * JNI bindings for whisper.cpp. Each method maps to a native function in whisper_jni.cpp.
  *
@@ -16,17 +18,52 @@ internal class WhisperNative {
   /**
    * Initialise a whisper context from a GGML model file.
    *
-   * @return opaque native pointer (0 on failure).
+   * @return opaque native pointer (0 on failure, including when no CPU backend could be loaded).
    */
   external fun init(modelPath: String): Long
 
   /**
    * Run full transcription on 16 kHz mono PCM samples.
    *
-   * @return array of `[text, startMs, endMs]` string triples, or null on error.
+   * @param withTokenProbs also collect per-token probabilities into the result.
+   * @param nThreads worker threads, pinned to the fastest cores; 0 for [defaultThreadCount].
+   * @return packed segments, or null on error.
+   */
+  external fun transcribe(
+    ctx: Long,
+    pcm: FloatArray,
+    language: String,
+    withTokenProbs: Boolean,
+    nThreads: Int,
+  ): NativeTranscript?
+
+  /** Thread count from CPU topology: cores within 80% of the fastest core's max frequency. */
+  external fun defaultThreadCount(): Int
+
+  /**
+   * Time the encoder with 1..[maxThreads] threads and return the fastest count, or 0 if
+   * calibration failed or was stopped. Takes a few encoder passes; run once per device, off the
+   * request path, and persist the result.
+   *
+   * Uses a whisper state of its own, so it may run while [transcribe] uses the same context.
+   * [shouldStop] is polled on the calling thread around every encoder pass.
    */
-  external fun transcribe(ctx: Long, pcm: FloatArray, language: String): Array<Array<String>>?
+  external fun calibrateThreadCount(ctx: Long, maxThreads: Int, shouldStop: BooleanSupplier): Int
 
   /** Free the native whisper context. */
   external fun free(ctx: Long)
+
+  /** ggml CPU backend variants compiled into the library, most capable first. */
+  external fun cpuVariants(): Array<String>
+
+  /** CPU backend variant in use, or null if none could be loaded. */
+  external fun cpuVariant(): String?
+
+  /**
+   * Replace the CPU backend. Refused while any context from [init] has not been [free]d.
+   *
+   * @param name variant to load, or null to pick the best one supported by this CPU.
+   * @return the loaded variant, or null if refused, unsupported or failed to load.
+   */
+  external fun selectCpuVariant(name: String?): String?
 }
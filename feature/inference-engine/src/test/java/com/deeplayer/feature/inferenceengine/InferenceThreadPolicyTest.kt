@@ -0,0 +1,86 @@
+package com.deeplayer.feature.inferenceengine
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.Test
+
+class InferenceThreadPolicyTest {
+
+  @Test
+  fun `uses default until calibration is recorded`() {
+    val policy = InferenceThreadPolicy()
+
+    assertThat(policy.needsCalibration).isTrue()
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(4)
+
+    assertThat(policy.recordCalibration(3)).isTrue()
+
+    assertThat(policy.needsCalibration).isFalse()
+    assertThat(policy.calibratedThreadCount).isEqualTo(3)
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(3)
+  }
+
+  @Test
+  fun `override takes precedence over calibration`() {
+    val policy = InferenceThreadPolicy()
+    policy.recordCalibration(3)
+
+    policy.overrideThreadCount = 2
+
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(2)
+  }
+
+  @Test
+  fun `override makes calibration unnecessary`() {
+    val policy = InferenceThreadPolicy()
+
+    policy.overrideThreadCount = 2
+
+    assertThat(policy.needsCalibration).isFalse()
+  }
+
+  @Test
+  fun `clearing override falls back to calibrated count`() {
+    val policy = InferenceThreadPolicy()
+    policy.recordCalibration(5)
+    policy.overrideThreadCount = 2
+    policy.overrideThreadCount = null
+
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(5)
+  }
+
+  @Test
+  fun `failed calibration is not recorded and is retried`() {
+    val policy = InferenceThreadPolicy()
+
+    assertThat(policy.recordCalibration(0)).isFalse()
+    assertThat(policy.recordCalibration(-1)).isFalse()
+
+    assertThat(policy.needsCalibration).isTrue()
+    assertThat(policy.calibratedThreadCount).isNull()
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(4)
+  }
+
+  @Test
+  fun `disabled calibration uses default`() {
+    val policy = InferenceThreadPolicy(calibrate = false)
+
+    assertThat(policy.needsCalibration).isFalse()
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(4)
+  }
+
+  @Test
+  fun `resetCalibration measures again`() {
+    val policy = InferenceThreadPolicy()
+    policy.recordCalibration(3)
+
+    policy.resetCalibration()
+
+    assertThat(policy.needsCalibration).isTrue()
+    assertThat(policy.resolve(defaultCount = { 4 })).isEqualTo(4)
+  }
+
+  @Test(expected = IllegalArgumentException::class)
+  fun `override rejects non-positive counts`() {
+    InferenceThreadPolicy().overrideThreadCount = 0
+  }
+}
@@ -0,0 +1,84 @@
+package com.deeplayer.feature.inferenceengine
+
+import com.google.common.truth.Truth.assertThat
+import org.junit.Test
+
+class NativeTranscriptTest {
+
+  private fun pack(vararg segments: Triple<ByteArray, Long, Long>): NativeTranscript {
+    val times = LongArray(segments.size * 2)
+    val offsets = IntArray(segments.size + 1)
+    var text = ByteArray(0)
+    segments.forEachIndexed { i, (bytes, start, end) ->
+      times[2 * i] = start
+      times[2 * i + 1] = end
+      text += bytes
+      offsets[i + 1] = text.size
+    }
+    return NativeTranscript(times, offsets, text, tokenOffsets = null, tokenProbs = null)
+  }
+
+  @Test
+  fun `unpacks text and timestamps per segment`() {
+    val raw =
+      pack(
+        Triple(" hello".toByteArray(), 0L, 500L),
+        Triple(" 안녕".toByteArray(), 500L, 1200L),
+      )
+
+    assertThat(raw.size).isEqualTo(2)
+    assertThat(raw.text(0)).isEqualTo(" hello")
+    assertThat(raw.text(1)).isEqualTo(" 안녕")
+    assertThat(raw.startMs(1)).isEqualTo(500L)
+    assertThat(raw.endMs(1)).isEqualTo(1200L)
+    assertThat(raw.tokenProbs(0)).isNull()
+  }
+
+  @Test
+  fun `empty transcript has no segments`() {
+    val raw = pack()
+
+    assertThat(raw.size).isEqualTo(0)
+    assertThat(WhisperCppTranscriber.toSegments(raw)).isEmpty()
+  }
+
+  @Test
+  fun `toSegments drops split UTF-8 and punctuation-only segments`() {
+    val hangul = "한".toByteArray()
+    val raw =
+      pack(
+        Triple(hangul.copyOfRange(0, 2), 0L, 100L), // first half of a split BPE token
+        Triple(" ...".toByteArray(), 100L, 200L),
+        Triple(" 노래".toByteArray(), 200L, 800L),
+      )
+
+    val segments = WhisperCppTranscriber.toSegments(raw)
+
+    assertThat(segments).hasSize(1)
+    assertThat(segments[0].text).isEqualTo("노래")
+    assertThat(segments[0].startMs).isEqualTo(200L)
+    assertThat(segments[0].endMs).isEqualTo(800L)
+  }
+
+  @Test
+  fun `toSegments drops segments with inverted timestamps`() {
+    val raw = pack(Triple(" word".toByteArray(), 900L, 100L))
+
+    assertThat(WhisperCppTranscriber.toSegments(raw)).isEmpty()
+  }
+
+  @Test
+  fun `tokenProbs slices per segment`() {
+    val raw =
+      NativeTranscript(
+        timesMs = longArrayOf(0, 100, 100, 200),
+        textOffsets = intArrayOf(0, 1, 2),
+        text = "ab".toByteArray(),
+        tokenOffsets = intArrayOf(0, 2, 3),
+        tokenProbs = floatArrayOf(0.9f, 0.8f, 0.5f),
+      )
+
+    assertThat(raw.tokenProbs(0)).isEqualTo(floatArrayOf(0.9f, 0.8f))
+    assertThat(raw.tokenProbs(1)).isEqualTo(floatArrayOf(0.5f))
+  }
+}
@@ -1,6 +1,7 @@
 package com.deeplayer.feature.lyricsaligner
 
 import com.deeplayer.core.contracts.AlignmentResult
+import com.deeplayer.core.contracts.FrameMatrix
 import com.deeplayer.core.contracts.Language
 import com.deeplayer.core.contracts.LineAlignment
 import com.deeplayer.core.contracts.LyricsAligner
@@ -44,6 +45,23 @@ override fun align(
     phonemeProbabilities: FloatArray,
     frameDurationMs: Float,
     language: Language,
+  ): AlignmentResult {
+    val vocabSize = phonemeVocab.size
+    val numFrames = phonemeProbabilities.size / vocabSize
+    return align(
+      lyrics,
+      FrameMatrix.Float32(phonemeProbabilities, numFrames, vocabSize),
+      frameDurationMs,
+      language,
+    )
+  }
+
+  /** Reads compact encodings one frame at a time in [CtcForcedAligner], never expanded whole. */
+  override fun align(
+    lyrics: List<String>,
+    phonemeLogProbs: FrameMatrix,
+    frameDurationMs: Float,
+    language: Language,
   ): AlignmentResult {
     if (lyrics.isEmpty()) {
       return AlignmentResult(
@@ -54,9 +72,10 @@ override fun align(
       )
     }
 
-    val vocabSize = phonemeVocab.size
-    val numFrames = phonemeProbabilities.size / vocabSize
-    if (numFrames == 0) {
+    require(phonemeLogProbs.numColumns == phonemeVocab.size) {
+      "Expected ${phonemeVocab.size} phoneme columns, got ${phonemeLogProbs.numColumns}"
+    }
+    if (phonemeLogProbs.numFrames == 0) {
       return AlignmentResult(
         words = emptyList(),
         lines = emptyList(),
@@ -91,8 +110,7 @@ override fun align(
     val allPhonemeIndices = wordInfos.flatMap { it.phonemeIndices.toList() }.toIntArray()
 
     // Step 3: CTC Forced Alignment
-    val alignedPhonemes =
-      ctcAligner.align(phonemeProbabilities, numFrames, vocabSize, allPhonemeIndices)
+    val alignedPhonemes = ctcAligner.align(phonemeLogProbs, allPhonemeIndices)
 
     // Step 4: Convert frames to timestamps
     val timestamped = timestampConverter.convert(alignedPhonemes, frameDurationMs)
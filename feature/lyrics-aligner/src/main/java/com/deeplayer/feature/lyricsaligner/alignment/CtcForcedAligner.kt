@@ -1,5 +1,7 @@
 package com.deeplayer.feature.lyricsaligner.alignment
 
+import com.deeplayer.core.contracts.FrameMatrix
+
 /**
  * CTC Forced Alignment using Viterbi-style dynamic programming.
  *
@@ -42,7 +44,18 @@ fun align(
     numFrames: Int,
     vocabSize: Int,
     phonemeSequence: IntArray,
-  ): List<AlignedPhoneme> {
+  ): List<AlignedPhoneme> =
+    align(FrameMatrix.Float32(logProbs, numFrames, vocabSize), phonemeSequence)
+
+  /**
+   * Perform CTC forced alignment on a log-probability matrix in any [FrameMatrix] encoding. Compact
+   * encodings are decoded one frame at a time, never expanded as a whole.
+   *
+   * @param logProbs log-probability matrix [numFrames x vocabSize]
+   * @param phonemeSequence expected phoneme indices (from G2P, indices into vocab)
+   */
+  fun align(logProbs: FrameMatrix, phonemeSequence: IntArray): List<AlignedPhoneme> {
+    val numFrames = logProbs.numFrames
     if (phonemeSequence.isEmpty() || numFrames == 0) return emptyList()
 
     // Build extended label sequence with blanks interleaved
@@ -64,18 +77,23 @@ fun align(
     // Backpointer for traceback: backptr[t][s] = previous extended label index at t-1
     val backptr = Array(numFrames) { IntArray(extLen) { -1 } }
 
+    // Current frame of log-probs, decoded once per frame
+    val frame = FloatArray(logProbs.numColumns)
+
     // Initialize: at frame 0, can start with blank (ext[0]) or first phoneme (ext[1])
-    prev[0] = logProb(logProbs, 0, extLabels[0], vocabSize)
+    logProbs.copyFrame(0, frame)
+    prev[0] = frame[extLabels[0]]
     if (extLen > 1) {
-      prev[1] = logProb(logProbs, 0, extLabels[1], vocabSize)
+      prev[1] = frame[extLabels[1]]
     }
 
     // Fill DP
     for (t in 1 until numFrames) {
       curr.fill(negInf)
+      logProbs.copyFrame(t, frame)
 
       for (s in 0 until extLen) {
-        val logProbTs = logProb(logProbs, t, extLabels[s], vocabSize)
+        val logProbTs = frame[extLabels[s]]
 
         // Option 1: Stay on same label (self-loop)
         var bestPrev = prev[s]
@@ -121,7 +139,7 @@ fun align(
     }
 
     // Convert path to aligned phonemes
-    return extractAlignments(path, extLabels, logProbs, vocabSize, phonemeSequence)
+    return extractAlignments(path, extLabels, logProbs, phonemeSequence)
   }
 
   /**
@@ -139,14 +157,30 @@ fun isBlankHeavy(
     endFrame: Int,
     vocabSize: Int,
     threshold: Float = 0.8f,
+  ): Boolean =
+    isBlankHeavy(
+      FrameMatrix.Float32(logProbs, logProbs.size / vocabSize, vocabSize),
+      startFrame,
+      endFrame,
+      threshold,
+    )
+
+  /** [isBlankHeavy] on a log-probability matrix in any [FrameMatrix] encoding. */
+  fun isBlankHeavy(
+    logProbs: FrameMatrix,
+    startFrame: Int,
+    endFrame: Int,
+    threshold: Float = 0.8f,
   ): Boolean {
     if (startFrame >= endFrame) return true
+    val frame = FloatArray(logProbs.numColumns)
     var blankCount = 0
     for (t in startFrame until endFrame) {
+      logProbs.copyFrame(t, frame)
       var maxIdx = 0
-      var maxVal = logProb(logProbs, t, 0, vocabSize)
-      for (v in 1 until vocabSize) {
-        val p = logProb(logProbs, t, v, vocabSize)
+      var maxVal = frame[0]
+      for (v in 1 until frame.size) {
+        val p = frame[v]
         if (p > maxVal) {
           maxVal = p
           maxIdx = v
@@ -160,14 +194,14 @@ fun isBlankHeavy(
   private fun extractAlignments(
     path: IntArray,
     extLabels: IntArray,
-    logProbs: FloatArray,
-    vocabSize: Int,
+    logProbs: FrameMatrix,
     @Suppress("UnusedParameter") phonemeSequence: IntArray,
   ): List<AlignedPhoneme> {
+    val vocabSize = logProbs.numColumns
     val result = mutableListOf<AlignedPhoneme>()
     var currentExtLabel = path[0]
     var startFrame = 0
-    var sumLogProb = logProb(logProbs, 0, extLabels[path[0]], vocabSize)
+    var sumLogProb = logProbs[0, extLabels[path[0]]]
     var frameCount = 1
 
     for (t in 1 until path.size) {
@@ -194,7 +228,7 @@ private fun extractAlignments(
         sumLogProb = 0f
         frameCount = 0
       }
-      sumLogProb += logProb(logProbs, t, extLabels[path[t]], vocabSize)
+      sumLogProb += logProbs[t, extLabels[path[t]]]
       frameCount++
     }
 
@@ -234,8 +268,4 @@ private fun computeConfidence(sumLogProb: Float, frameCount: Int, vocabSize: Int
     val normalized = 1f - (avgLogProb / uniformLogProb)
     return normalized.coerceIn(0f, 1f)
   }
-
-  private fun logProb(logProbs: FloatArray, frame: Int, vocab: Int, vocabSize: Int): Float {
-    return logProbs[frame * vocabSize + vocab]
-  }
 }
@@ -0,0 +1,167 @@
+package com.deeplayer.feature.lyricsaligner.alignment
+
+import com.deeplayer.core.contracts.FrameFormat
+import com.deeplayer.core.contracts.FrameMatrix
+import com.deeplayer.core.contracts.Language
+import com.deeplayer.core.contracts.LyricsAligner
+import com.deeplayer.feature.lyricsaligner.FakeLyricsAligner
+import com.deeplayer.feature.lyricsaligner.LyricsAlignerImpl
+import com.deeplayer.feature.lyricsaligner.g2p.CodeSwitchDetector
+import com.deeplayer.feature.lyricsaligner.g2p.EnglishG2P
+import com.deeplayer.feature.lyricsaligner.g2p.KoreanG2P
+import com.google.common.truth.Truth.assertThat
+import java.util.Random
+import kotlin.math.abs
+import kotlin.math.exp
+import kotlin.math.ln
+import org.junit.Before
+import org.junit.Test
+
+/** Alignment on FLOAT16 / INT8 log-probs must match the float32 result. */
+class CompactLogProbTest {
+
+  private lateinit var aligner: CtcForcedAligner
+
+  @Before
+  fun setUp() {
+    aligner = CtcForcedAligner()
+    aligner.blankIndex = 0
+  }
+
+  /** Same fixture as SyntheticAlignmentTest: one dominant token per frame range. */
+  private fun buildSyntheticLogProbs(
+    numFrames: Int,
+    vocabSize: Int,
+    assignments: List<Pair<IntRange, Int>>,
+    dominantProb: Float = 0.9f,
+  ): FloatArray {
+    val logBg = ln((1f - dominantProb) / (vocabSize - 1))
+    val logProbs = FloatArray(numFrames * vocabSize) { logBg }
+    for ((range, vocabIdx) in assignments) {
+      for (t in range) logProbs[t * vocabSize + vocabIdx] = ln(dominantProb)
+    }
+    return logProbs
+  }
+
+  /**
+   * Log-softmax of unit Gaussian logits with the labelled token boosted, over the model's 81-token
+   * vocabulary: [numPhonemes] segments of 40 frames separated by 10 blank frames.
+   */
+  private fun buildNoisyLogProbs(numPhonemes: Int, vocabSize: Int, seed: Long): FloatArray {
+    val random = Random(seed)
+    val numFrames = 10 + numPhonemes * 50
+    val labels = IntArray(numFrames)
+    for (p in 0 until numPhonemes) {
+      val start = 10 + p * 50
+      for (t in start until start + 40) labels[t] = p % (vocabSize - 2) + 1
+    }
+    val logProbs = FloatArray(numFrames * vocabSize)
+    val logits = DoubleArray(vocabSize)
+    for (t in 0 until numFrames) {
+      for (v in 0 until vocabSize) logits[v] = random.nextGaussian()
+      logits[labels[t]] += 5.0
+      val logSum = ln(logits.sumOf { exp(it) })
+      for (v in 0 until vocabSize) logProbs[t * vocabSize + v] = (logits[v] - logSum).toFloat()
+    }
+    return logProbs
+  }
+
+  private fun assertSameAlignment(
+    expected: List<CtcForcedAligner.AlignedPhoneme>,
+    actual: List<CtcForcedAligner.AlignedPhoneme>,
+    frameTolerance: Int,
+  ) {
+    val expectedPhonemes = expected.filter { !it.isBlank }
+    val actualPhonemes = actual.filter { !it.isBlank }
+    assertThat(actualPhonemes.map { it.phonemeLabel })
+      .containsExactlyElementsIn(expectedPhonemes.map { it.phonemeLabel })
+      .inOrder()
+    for ((e, a) in expectedPhonemes.zip(actualPhonemes)) {
+      assertThat(abs(a.startFrame - e.startFrame)).isAtMost(frameTolerance)
+      assertThat(abs(a.endFrame - e.endFrame)).isAtMost(frameTolerance)
+      assertThat(a.confidence).isWithin(0.01f).of(e.confidence)
+    }
+  }
+
+  @Test
+  fun `compact encodings reproduce ABCD alignment exactly`() {
+    val vocabSize = 5
+    val numFrames = 200
+    val logProbs =
+      buildSyntheticLogProbs(
+        numFrames,
+        vocabSize,
+        listOf(5..44 to 1, 55..94 to 2, 105..144 to 3, 155..194 to 4),
+      )
+    val sequence = intArrayOf(1, 2, 3, 4)
+    val expected = aligner.align(logProbs, numFrames, vocabSize, sequence)
+
+    for (format in listOf(FrameFormat.FLOAT16, FrameFormat.INT8)) {
+      val compact = FrameMatrix.encode(logProbs, vocabSize, format)
+      assertSameAlignment(expected, aligner.align(compact, sequence), frameTolerance = 0)
+    }
+  }
+
+  @Test
+  fun `noisy model output aligns within one frame after compaction`() {
+    val vocabSize = 81
+    val numPhonemes = 30
+    val sequence = IntArray(numPhonemes) { it % (vocabSize - 2) + 1 }
+
+    for (seed in 1L..3L) {
+      val logProbs = buildNoisyLogProbs(numPhonemes, vocabSize, seed)
+      val numFrames = logProbs.size / vocabSize
+      val expected = aligner.align(logProbs, numFrames, vocabSize, sequence)
+      assertThat(expected.count { !it.isBlank }).isEqualTo(numPhonemes)
+
+      for (format in listOf(FrameFormat.FLOAT16, FrameFormat.INT8)) {
+        val compact = FrameMatrix.encode(logProbs, vocabSize, format)
+        assertSameAlignment(expected, aligner.align(compact, sequence), frameTolerance = 1)
+      }
+    }
+  }
+
+  @Test
+  fun `LyricsAligner accepts a frame matrix in place of a float array`() {
+    val vocabSize = FakeLyricsAligner.VOCAB_SIZE
+    val logProbs = buildNoisyLogProbs(numPhonemes = 12, vocabSize = vocabSize, seed = 7)
+    val matrix = FrameMatrix.encode(logProbs, vocabSize, FrameFormat.FLOAT32)
+    val lyrics = listOf("love baby", "heart")
+    val lyricsAligners: List<LyricsAligner> =
+      listOf(
+        LyricsAlignerImpl(KoreanG2P(), EnglishG2P(), CodeSwitchDetector()),
+        FakeLyricsAligner(),
+      )
+
+    for (lyricsAligner in lyricsAligners) {
+      val expected = lyricsAligner.align(lyrics, logProbs, 20f, Language.EN)
+      assertThat(expected.words).isNotEmpty()
+      assertThat(lyricsAligner.align(lyrics, matrix, 20f, Language.EN)).isEqualTo(expected)
+    }
+  }
+
+  @Test
+  fun `blank detection agrees across encodings`() {
+    val vocabSize = 5
+    val logProbs =
+      buildSyntheticLogProbs(100, vocabSize, listOf(0..49 to 1, 50..99 to 0), dominantProb = 0.6f)
+
+    for (format in FrameFormat.entries) {
+      val matrix = FrameMatrix.encode(logProbs, vocabSize, format)
+      assertThat(aligner.isBlankHeavy(matrix, 0, 50)).isFalse()
+      assertThat(aligner.isBlankHeavy(matrix, 50, 100)).isTrue()
+    }
+  }
+
+  @Test
+  fun `compact encodings halve and quarter a long track`() {
+    // ~3.5 minutes at 20ms/frame over the 81-token vocabulary
+    val logProbs = FloatArray(10500 * 81) { -4.4f }
+
+    val float32 = FrameMatrix.encode(logProbs, 81, FrameFormat.FLOAT32).sizeInBytes
+    val float16 = FrameMatrix.encode(logProbs, 81, FrameFormat.FLOAT16).sizeInBytes
+    val int8 = FrameMatrix.encode(logProbs, 81, FrameFormat.INT8).sizeInBytes
+    assertThat(float16).isEqualTo(float32 / 2)
+    assertThat(int8.toDouble()).isLessThan(float32 * 0.28)
+  }
+}
@@ -0,0 +1,58 @@
+#!/bin/bash
+# Benchmark Whisper transcription on every ggml CPU kernel variant built into the
+# host native library (e.g. x64 / haswell / skylakex on Linux x86_64).
+#
+# Usage:
+#   ./scripts/bench_whisper_variants.sh <audio_file> [language]
+#
+# Prerequisites: same as test_alignment.sh (ffmpeg, JDK 17+).
+#
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+BUILD_DIR="$PROJECT_ROOT/build/whisper-host"
+MODEL_FILE="$BUILD_DIR/ggml-tiny.bin"
+if [ "$(uname)" = "Darwin" ]; then
+  NATIVE_LIB="$BUILD_DIR/libwhisper_jni.dylib"
+else
+  NATIVE_LIB="$BUILD_DIR/libwhisper_jni.so"
+fi
+
+if [ $# -lt 1 ]; then
+  echo "Usage: $0 <audio_file> [language]"
+  exit 1
+fi
+
+AUDIO_FILE="$(cd "$(dirname "$1")" && pwd)/$(basename "$1")"
+LANGUAGE="${2:-ko}"
+
+if [ ! -f "$NATIVE_LIB" ]; then
+  echo "=== Building whisper.cpp for host ==="
+  "$SCRIPT_DIR/build_whisper_host.sh"
+fi
+
+if [ ! -f "$MODEL_FILE" ]; then
+  echo "=== Downloading ggml-tiny.bin ==="
+  curl -L --progress-bar \
+    "https://huggingface.co/ggerganov/whisper.cpp/resolve/main/ggml-tiny.bin" \
+    -o "$MODEL_FILE"
+fi
+
+PCM_FILE="$BUILD_DIR/bench_audio.pcm"
+ffmpeg -y -i "$AUDIO_FILE" -ar 16000 -ac 1 -f f32le -acodec pcm_f32le "$PCM_FILE" 2>/dev/null
+
+cd "$PROJECT_ROOT"
+./gradlew :feature:alignment-orchestrator:testDebugUnitTest \
+  --tests "com.deeplayer.feature.alignmentorchestrator.WhisperCpuVariantBenchmarkTest" \
+  -Dwhisper.native.lib="$NATIVE_LIB" \
+  -Dwhisper.model.path="$MODEL_FILE" \
+  -Dwhisper.pcm.path="$PCM_FILE" \
+  -Dwhisper.language="$LANGUAGE" \
+  2>&1 | grep -v "^$" | grep -v "^>" | grep -v "^BUILD" | grep -v "^Configuration" || true
+
+RESULT_FILE="$BUILD_DIR/cpu_variant_benchmark.txt"
+if [ -f "$RESULT_FILE" ]; then
+  echo ""
+  cat "$RESULT_FILE"
+fi
@@ -1,6 +1,7 @@
 #!/bin/bash
-# Build whisper.cpp JNI library for the host platform (macOS) for local testing.
-# Output: build/whisper-host/libwhisper_jni.dylib
+# Build whisper.cpp JNI library for the host platform for local testing.
+# Output: build/whisper-host/libwhisper_jni.dylib (macOS, single built-in CPU backend)
+#         build/whisper-host/libwhisper_jni.so + libggml-*.so (Linux, runtime CPU variant dispatch)
 set -euo pipefail
 
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
@@ -42,6 +43,19 @@ if [ ! -d "$WHISPER_DIR" ]; then
   exit 1
 fi
 
+# Linux: build with the module's CMakeLists.txt, which produces one ggml CPU
+# backend per instruction set (x64 / haswell / skylakex) and picks the best at load time.
+if [ "$(uname)" != "Darwin" ]; then
+  echo "=== Building whisper.cpp JNI for host ($(uname -m)) with CPU variants ==="
+  cmake -S "$CPP_DIR" -B "$OUT_DIR/cmake" -DCMAKE_BUILD_TYPE=Release -DJAVA_HOME="$JAVA_HOME"
+  cmake --build "$OUT_DIR/cmake" -j"$(nproc)"
+  cp "$OUT_DIR"/cmake/lib*.so "$OUT_DIR/"
+  echo ""
+  echo "=== Build successful ==="
+  ls -lh "$OUT_DIR"/lib*.so
+  exit 0
+fi
+
 mkdir -p "$OBJ_DIR"
 
 echo "=== Building whisper.cpp JNI for host ($(uname -m)) ==="
@@ -109,6 +123,8 @@ fi
 echo "Compiling whisper + JNI..."
 compile_cpp "$WHISPER_DIR/src/whisper.cpp"     "whisper"
 compile_cpp "$CPP_DIR/whisper_jni.cpp"         "whisper_jni"
+compile_cpp "$CPP_DIR/cpu_backend.cpp"         "cpu_backend"
+compile_cpp "$CPP_DIR/thread_policy.cpp"       "thread_policy"
 
 echo "Linking $LIB_NAME..."
 clang++ -shared -o "$OUT_DIR/$LIB_NAME" "$OBJ_DIR"/*.o \
@@ -0,0 +1,41 @@
+#pragma once
+
+// Assertions shared by the host-side C++ tests that
+// scripts/run_native_tests.sh builds. Each test is a plain executable:
+// EXPECT records a failure and carries on, and main() ends with
+// `return native_test::finish("<name>");`.
+
+#include <atomic>
+#include <cstdio>
+
+namespace native_test {
+
+/** Failed EXPECTs so far, in any thread. */
+inline std::atomic<int> g_failures{0};
+
+/**
+ * Print "<name>: OK", or the failure count to stderr.
+ * @return the process exit status.
+ */
+inline int finish(const char* name) {
+  if (g_failures > 0) {
+    std::fprintf(stderr, "%d failure(s)\n", g_failures.load());
+    return 1;
+  }
+  std::printf("%s: OK\n", name);
+  return 0;
+}
+
+}  // namespace native_test
+
+/** Check cond; on failure print its location and a printf-style message. */
+#define EXPECT(cond, ...)                                             \
+  do {                                                                \
+    if (!(cond)) {                                                    \
+      std::fprintf(stderr, "%s:%d: FAILED %s: ", __FILE__, __LINE__, \
+                   #cond);                                            \
+      std::fprintf(stderr, __VA_ARGS__);                              \
+      std::fprintf(stderr, "\n");                                     \
+      native_test::g_failures++;                                      \
+    }                                                                 \
+  } while (0)
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Build and run the host-side C++ unit tests of every module (src/test/cpp).
+# Their shared EXPECT/finish() harness is native_test/native_test.h.
+# Usage: scripts/run_native_tests.sh [--asan]
+#   --asan  build with AddressSanitizer and UndefinedBehaviorSanitizer
+set -euo pipefail
+
+SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
+PROJECT_ROOT="$(dirname "$SCRIPT_DIR")"
+OUT_DIR="$PROJECT_ROOT/build/native-tests"
+
+ASAN=OFF
+if [ "${1:-}" = "--asan" ]; then
+  ASAN=ON
+fi
+
+status=0
+for test_dir in "$PROJECT_ROOT"/feature/*/src/test/cpp; do
+  [ -f "$test_dir/CMakeLists.txt" ] || continue
+  module="$(basename "$(dirname "$(dirname "$(dirname "$test_dir")")")")"
+  build_dir="$OUT_DIR/$module"
+  echo "=== $module ==="
+  cmake -S "$test_dir" -B "$build_dir" -DCMAKE_BUILD_TYPE=RelWithDebInfo -DENABLE_ASAN="$ASAN" >/dev/null
+  cmake --build "$build_dir" -j"$(nproc)"
+  ctest --test-dir "$build_dir" --output-on-failure || status=1
+done
+exit $status
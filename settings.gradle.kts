@@ -29,4 +29,5 @@
 include(":feature:audio-preprocessor")
 include(":feature:inference-engine")
 include(":feature:alignment-orchestrator")
+include(":feature:lyrics-aligner")
 include(":feature:lyrics-ui")